@@ -34,10 +34,12 @@ static void create_block(Node *n)
 	void check_block(Node *n);
 	void visit_block(Node *, Stack *);
 	void print_block(Node *, int);
+	void compile_block(Node *, struct code *);
 
 	n->check = check_block;
 	n->visit = visit_block;
 	n->print = print_block;
+	n->compile = compile_block;
 
 	n->block.statements = array.alloc();
 }
@@ -48,13 +50,16 @@ static void create_literal(Node *n, va_list argp)
 	void check_literal(Node *);
 	void print_literal(Node *, int);
 	void visit_literal(Node *, Stack *);
+	void compile_literal(Node *, struct code *);
 
 	n->check = check_literal;
 	n->print = print_literal;
 	n->visit = visit_literal;
+	n->compile = compile_literal;
 
 	n->literal.type = va_arg(argp, variabletype_t);
 	n->literal.value = strdup(va_arg(argp, char *));
+	n->literal.constant = NULL;
 }
 
 
@@ -63,10 +68,12 @@ static void create_unary(Node *n, va_list argp)
 	void check_unary(Node *n);
 	void print_unary(Node *, int);
 	void visit_unary(Node *, Stack *);
+	void compile_unary(Node *, struct code *);
 
 	n->check = check_unary;
 	n->print = print_unary;
 	n->visit = visit_unary;
+	n->compile = compile_unary;
 
 	n->unary.operator = va_arg(argp, unaryoperator_t);
 	n->unary.operand = va_arg(argp, Node *);
@@ -78,10 +85,12 @@ static void create_binary(Node *n, va_list argp)
 	void check_binary(Node *n);
 	void print_binary(Node *, int);
 	void visit_binary(Node *, Stack *);
+	void compile_binary(Node *, struct code *);
 
 	n->check = check_binary;
 	n->print = print_binary;
 	n->visit = visit_binary;
+	n->compile = compile_binary;
 
 	n->binary.operator = va_arg(argp, binaryoperator_t);
 	n->binary.left = va_arg(argp, Node *);
@@ -94,10 +103,12 @@ static void create_comma_expr(Node *n)
 	void check_comma_expr(Node *n);
 	void visit_comma_expr(Node *, Stack *);
 	void print_comma_expr(Node *, int);
+	void compile_comma_expr(Node *, struct code *);
 
 	n->check = check_comma_expr;
 	n->visit = visit_comma_expr;
 	n->print = print_comma_expr;
+	n->compile = compile_comma_expr;
 
 	n->comma_expr.expressions = array.alloc();
 }
@@ -108,10 +119,12 @@ static void create_arglist(Node *n)
 	void check_arglist(Node *n);
 	void print_arglist(Node *, int);
 	void visit_arglist(Node *, Stack *);
+	void compile_arglist(Node *, struct code *);
 
 	n->check = check_arglist;
 	n->print = print_arglist;
 	n->visit = visit_arglist;
+	n->compile = compile_arglist;
 
 	n->arglist.arguments = array.alloc();
 }
@@ -122,10 +135,12 @@ static void create_index(Node *n, va_list argp)
 	void check_index(Node *n);
 	void visit_index(Node *, Stack *);
 	void print_index(Node *, int);
+	void compile_index(Node *, struct code *);
 
 	n->check = check_index;
 	n->visit = visit_index;
 	n->print = print_index;
+	n->compile = compile_index;
 
 	n->index.sequence = va_arg(argp, Node *);
 	n->index.index = va_arg(argp, Node *);
@@ -137,10 +152,12 @@ static void create_slice(Node *n, va_list argp)
 	void check_slice(Node *n);
 	void visit_slice(Node *, Stack *);
 	void print_slice(Node *, int);
+	void compile_slice(Node *, struct code *);
 
 	n->check = check_slice;
 	n->visit = visit_slice;
 	n->print = print_slice;
+	n->compile = compile_slice;
 
 	n->slice.sequence = va_arg(argp, Node *);
 	n->slice.start = va_arg(argp, Node *);
@@ -148,15 +165,55 @@ static void create_slice(Node *n, va_list argp)
 }
 
 
+static void create_index_store(Node *n, va_list argp)
+{
+	void check_index_store(Node *n);
+	void visit_index_store(Node *, Stack *);
+	void print_index_store(Node *, int);
+	void compile_index_store(Node *, struct code *);
+
+	n->check = check_index_store;
+	n->visit = visit_index_store;
+	n->print = print_index_store;
+	n->compile = compile_index_store;
+
+	n->index_store.operator = va_arg(argp, assignmentoperator_t);
+	n->index_store.sequence = va_arg(argp, Node *);
+	n->index_store.index = va_arg(argp, Node *);
+	n->index_store.expression = va_arg(argp, Node *);
+}
+
+
+static void create_index_update(Node *n, va_list argp)
+{
+	void check_index_store(Node *n);
+	void visit_index_update(Node *, Stack *);
+	void print_index_store(Node *, int);
+	void compile_index_update(Node *, struct code *);
+
+	n->check = check_index_store;
+	n->visit = visit_index_update;
+	n->print = print_index_store;
+	n->compile = compile_index_update;
+
+	n->index_store.operator = va_arg(argp, assignmentoperator_t);
+	n->index_store.sequence = va_arg(argp, Node *);
+	n->index_store.index = va_arg(argp, Node *);
+	n->index_store.expression = va_arg(argp, Node *);
+}
+
+
 static void create_assignment(Node *n, va_list argp)
 {
 	void check_assignment(Node *n);
 	void visit_assignment(Node *, Stack *);
 	void print_assignment(Node *, int);
+	void compile_assignment(Node *, struct code *);
 
 	n->check = check_assignment;
 	n->visit = visit_assignment;
 	n->print = print_assignment;
+	n->compile = compile_assignment;
 
 	n->assignment.operator = va_arg(argp, assignmentoperator_t);
 	n->assignment.variable = va_arg(argp, Node *);
@@ -169,10 +226,12 @@ static void create_reference(Node *n, va_list argp)
 	void check_reference(Node *n);
 	void visit_reference(Node *, Stack *);
 	void print_reference(Node *, int);
+	void compile_reference(Node *, struct code *);
 
 	n->check = check_reference;
 	n->visit = visit_reference;
 	n->print = print_reference;
+	n->compile = compile_reference;
 
 	n->reference.name = strdup(va_arg(argp, char *));
 }
@@ -183,15 +242,17 @@ static void create_function_call(Node *n, va_list argp)
 	void check_function_call(Node *n);
 	void visit_function_call(Node *, Stack *);
 	void print_function_call(Node *n, int);
+	void compile_function_call(Node *, struct code *);
 
 	n->check = check_function_call;
 	n->visit = visit_function_call;
 	n->print = print_function_call;
+	n->compile = compile_function_call;
 
 	n->function_call.name = strdup(va_arg(argp, char *));
 	n->function_call.arguments = array.alloc();
 	n->function_call.builtin = va_arg(argp, int);  /* bool is promoted to int */
-	n->function_call.checked = false;
+	n->function_call.declaration = NULL;
 }
 
 
@@ -200,10 +261,12 @@ static void create_expression_stmnt(Node *n, va_list argp)
 	void check_expression_stmnt(Node *n);
 	void visit_expression_stmnt(Node *, Stack *);
 	void print_expression_stmnt(Node *, int);
+	void compile_expression_stmnt(Node *, struct code *);
 
 	n->check = check_expression_stmnt;
 	n->visit = visit_expression_stmnt;
 	n->print = print_expression_stmnt;
+	n->compile = compile_expression_stmnt;
 
 	n->expression_stmnt.expression = va_arg(argp, Node *);
 }
@@ -214,10 +277,12 @@ static void create_function_declaration(Node *n, va_list argp)
 	void check_function_declaration(Node *n);
 	void visit_function_declaration(Node *, Stack *);
 	void print_function_declaration(Node *n, int);
+	void compile_function_declaration(Node *, struct code *);
 
 	n->check = check_function_declaration;
 	n->visit = visit_function_declaration;
 	n->print = print_function_declaration;
+	n->compile = compile_function_declaration;
 
 	n->function_declaration.name = strdup(va_arg(argp, char *));
 	n->function_declaration.nested = va_arg(argp, int);  /* bool is promoted to int */
@@ -230,10 +295,12 @@ static void create_variable_declaration(Node *n)
 	void check_variable_declaration(Node *n);
 	void visit_variable_declaration(Node *, Stack *);
 	void print_variable_declaration(Node *, int);
+	void compile_variable_declaration(Node *, struct code *);
 
 	n->check = check_variable_declaration;
 	n->visit = visit_variable_declaration;
 	n->print = print_variable_declaration;
+	n->compile = compile_variable_declaration;
 
 	n->variable_declaration.defvars = array.alloc();
 }
@@ -244,10 +311,12 @@ static void create_defvar(Node *n, va_list argp)
 	void check_defvar(Node *n);
 	void visit_defvar(Node *, Stack *);
 	void print_defvar(Node *, int);
+	void compile_defvar(Node *, struct code *);
 
 	n->check = check_defvar;
 	n->visit = visit_defvar;
 	n->print = print_defvar;
+	n->compile = compile_defvar;
 
 	n->defvar.type = va_arg(argp, variabletype_t);
 	n->defvar.name = strdup(va_arg(argp, char *));
@@ -260,10 +329,12 @@ static void create_if_stmnt(Node *n)
 	void check_if_stmnt(Node *n);
 	void visit_if_stmnt(Node *, Stack *);
 	void print_if_stmnt(Node *, int);
+	void compile_if_stmnt(Node *, struct code *);
 
 	n->check = check_if_stmnt;
 	n->visit = visit_if_stmnt;
 	n->print = print_if_stmnt;
+	n->compile = compile_if_stmnt;
 
 	/* condition, consequent and alternative must be added
 	 * later in order to record the correct source code position
@@ -276,10 +347,12 @@ static void create_while_stmnt(Node *n)
 	void check_while_stmnt(Node *n);
 	void visit_while_stmnt(Node *, Stack *);
 	void print_while_stmnt(Node *, int);
+	void compile_while_stmnt(Node *, struct code *);
 
 	n->check = check_while_stmnt;
 	n->visit = visit_while_stmnt;
 	n->print = print_while_stmnt;
+	n->compile = compile_while_stmnt;
 
 	/* condition and block must be added later in order
 	 * to record the correct source code position
@@ -292,10 +365,12 @@ static void create_do_stmnt(Node *n, va_list argp)
 	void check_do_stmnt(Node *n);
 	void visit_do_stmnt(Node *, Stack *);
 	void print_do_stmnt(Node *, int);
+	void compile_do_stmnt(Node *, struct code *);
 
 	n->check = check_do_stmnt;
 	n->visit = visit_do_stmnt;
 	n->print = print_do_stmnt;
+	n->compile = compile_do_stmnt;
 
 	n->loop_stmnt.condition = va_arg(argp, Node *);
 	n->loop_stmnt.block = va_arg(argp, Node *);
@@ -307,10 +382,12 @@ static void create_for_stmnt(Node *n, va_list argp)
 	void check_for_stmnt(Node *n);
 	void visit_for_stmnt(Node *, Stack *);
 	void print_for_stmnt(Node *, int);
+	void compile_for_stmnt(Node *, struct code *);
 
 	n->check = check_for_stmnt;
 	n->visit = visit_for_stmnt;
 	n->print = print_for_stmnt;
+	n->compile = compile_for_stmnt;
 
 	n->for_stmnt.name = strdup(va_arg(argp, char *));
 	n->for_stmnt.expression = va_arg(argp, Node *);
@@ -326,10 +403,12 @@ static void create_print_stmnt(Node *n, va_list argp)
 	void check_print_stmnt(Node *n);
 	void visit_print_stmnt(Node *, Stack *);
 	void print_print_stmnt(Node *, int);
+	void compile_print_stmnt(Node *, struct code *);
 
 	n->check = check_print_stmnt;
 	n->visit = visit_print_stmnt;
 	n->print = print_print_stmnt;
+	n->compile = compile_print_stmnt;
 
 	n->print_stmnt.raw = va_arg(argp, int);
 	n->print_stmnt.expressions = array.alloc();
@@ -341,10 +420,12 @@ static void create_return_stmnt(Node *n, va_list argp)
 	void check_return_stmnt(Node *n);
 	void visit_return_stmnt(Node *, Stack *);
 	void print_return_stmnt(Node *, int);
+	void compile_return_stmnt(Node *, struct code *);
 
 	n->check = check_return_stmnt;
 	n->visit = visit_return_stmnt;
 	n->print = print_return_stmnt;
+	n->compile = compile_return_stmnt;
 
 	n->return_stmnt.value = va_arg(argp, Node *);
 }
@@ -355,10 +436,12 @@ static void create_import_stmnt(Node *n, va_list argp)
 	void check_import_stmnt(Node *n);
 	void visit_import_stmnt(Node *, Stack *);
 	void print_import_stmnt(Node *, int);
+	void compile_import_stmnt(Node *, struct code *);
 
 	n->check = check_import_stmnt;
 	n->visit = visit_import_stmnt;
 	n->print = print_import_stmnt;
+	n->compile = compile_import_stmnt;
 
 	n->import_stmnt.name = strdup(va_arg(argp, char *));
 	n->import_stmnt.code = va_arg(argp, Node *);
@@ -370,13 +453,16 @@ static void create_input_stmnt(Node *n)
 	void check_input_stmnt(Node *n);
 	void visit_input_stmnt(Node *, Stack *);
 	void print_input_stmnt(Node *n, int);
+	void compile_input_stmnt(Node *, struct code *);
 
 	n->check = check_input_stmnt;
 	n->visit = visit_input_stmnt;
 	n->print = print_input_stmnt;
+	n->compile = compile_input_stmnt;
 
 	n->input_stmnt.prompts = array.alloc();
 	n->input_stmnt.identifiers = array.alloc();
+	n->input_stmnt.locations = NULL;  /* allocated by check() */
 }
 
 
@@ -385,10 +471,12 @@ static void create_pass_stmnt(Node *n)
 	void check_pass_stmnt(Node *n);
 	void visit_pass_stmnt(Node *, Stack *);
 	void print_pass_stmnt(Node *, int);
+	void compile_pass_stmnt(Node *, struct code *);
 
 	n->check = check_pass_stmnt;
 	n->visit = visit_pass_stmnt;
 	n->print = print_pass_stmnt;
+	n->compile = compile_pass_stmnt;
 }
 
 
@@ -397,10 +485,12 @@ static void create_break_stmnt(Node *n)
 	void check_break_stmnt(Node *n);
 	void visit_break_stmnt(Node *, Stack *);
 	void print_break_stmnt(Node *, int);
+	void compile_break_stmnt(Node *, struct code *);
 
 	n->check = check_break_stmnt;
 	n->visit = visit_break_stmnt;
 	n->print = print_break_stmnt;
+	n->compile = compile_break_stmnt;
 }
 
 
@@ -409,10 +499,12 @@ static void create_continue_stmnt(Node *n)
 	void check_continue_stmnt(Node *n);
 	void visit_continue_stmnt(Node *, Stack *);
 	void print_continue_stmnt(Node *, int);
+	void compile_continue_stmnt(Node *, struct code *);
 
 	n->check = check_continue_stmnt;
 	n->visit = visit_continue_stmnt;
 	n->print = print_continue_stmnt;
+	n->compile = compile_continue_stmnt;
 }
 
 
@@ -434,11 +526,14 @@ Node *create(nodetype_t type, ...)
 		n->type = type;
 
 		/* record where we are in the code to be able to print error
-		 * or debug messages.
+		 * or debug messages. Nodes created after parsing (see optimize.c)
+		 * must set the source themselves.
 		 */
-		n->source.module = scanner.module;
-		n->source.lineno = scanner.module->lineno;
-		n->source.bol = scanner.module->bol;
+		if (scanner.module) {
+			n->source.module = scanner.module;
+			n->source.lineno = scanner.module->lineno;
+			n->source.bol = scanner.module->bol;
+		}
 
 		n->method.valid = false;
 
@@ -469,6 +564,12 @@ Node *create(nodetype_t type, ...)
 			case SLICE:
 				create_slice(n, argp);
 				break;
+			case INDEX_STORE:
+				create_index_store(n, argp);
+				break;
+			case INDEX_UPDATE:
+				create_index_update(n, argp);
+				break;
 			case ASSIGNMENT:
 				create_assignment(n, argp);
 				break;
@@ -529,3 +630,22 @@ Node *create(nodetype_t type, ...)
 	}
 	return n;
 }
+
+
+/* Is the value of this expression a literal? If so it must be
+ * copied before it can be used as the target of an assignment
+ * or returned from a function because literals are shared constants.
+ */
+bool is_constant(Node *n)
+{
+	if (n->method.valid == true)
+		return false;
+
+	if (n->type == LITERAL)
+		return true;
+
+	if (n->type == COMMA_EXPR)
+		return is_constant(n->comma_expr.expressions->element[n->comma_expr.expressions->size - 1]);
+
+	return false;
+}
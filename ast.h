@@ -12,13 +12,15 @@
 #include "stack.h"
 #include "array.h"
 
+struct code;  /* bytecode, see compile.h */
+
 
 /* All possible AST node types.
  */
 typedef enum { LITERAL=1, ARGLIST, UNARY, BINARY, ASSIGNMENT, BLOCK, REFERENCE, VARIABLE_DECLARATION,
 			   DEF_VAR, FUNCTION_DECLARATION, COMMA_EXPR, IF_STMNT, PRINT_STMNT, RETURN_STMNT, EXPRESSION_STMNT,
 			   WHILE_STMNT, DO_STMNT, PASS_STMNT, FOR_STMNT, IMPORT_STMNT, INPUT_STMNT,
-			   BREAK_STMNT, CONTINUE_STMNT, INDEX, SLICE, FUNCTION_CALL } nodetype_t;
+			   BREAK_STMNT, CONTINUE_STMNT, INDEX, SLICE, INDEX_STORE, INDEX_UPDATE, FUNCTION_CALL } nodetype_t;
 
 /* Printable name for every node type.
  */
@@ -28,7 +30,7 @@ static inline char *nodetypeName(nodetype_t nt)
 		"?", "LITERAL", "ARGLIST", "UNARY", "BINARY", "ASSIGNMENT", "BLOCK", "REFERENCE", "VARIABLE_DECLARATION",
 		"DEF_VAR", "FUNCTION_DECLARATION", "COMMA_EXPR", "IF_STMNT", "PRINT_STMNT", "RETURN_STMNT", "EXPRESSION_STMNT",
 		"WHILE_STMNT", "DO_STMNT", "PASS_STMNT", "FOR_STMNT", "IMPORT_STMNT", "INPUT_STMNT",
-		"BREAK_STMNT", "CONTINUE_STMNT", "INDEX", "SLICE", "FUNCTION_CALL"
+		"BREAK_STMNT", "CONTINUE_STMNT", "INDEX", "SLICE", "INDEX_STORE", "INDEX_UPDATE", "FUNCTION_CALL"
 	};
 
 	if (nt < 0 || nt > (sizeof(string) / sizeof(string[0]) - 1))
@@ -93,12 +95,12 @@ static inline char *assignmentoperatorName(assignmentoperator_t op)
 
 /* All possible literal variable types.
  */
-typedef enum { VT_CHAR=1, VT_INT, VT_FLOAT, VT_STR, VT_LIST } variabletype_t;
+typedef enum { VT_CHAR=1, VT_INT, VT_FLOAT, VT_STR, VT_LIST, VT_DICT, VT_SET, VT_ARRAY } variabletype_t;
 
 static inline char *variabletypeName(variabletype_t vt)
 {
 	static char *string[] = {
-		"?", "CHAR", "INT", "FLOAT", "STR", "LIST"
+		"?", "CHAR", "INT", "FLOAT", "STR", "LIST", "DICT", "SET", "ARRAY"
 	};
 
 	if (vt < 0 || vt > (sizeof(string) / sizeof(string[0]) - 1))
@@ -108,6 +110,16 @@ static inline char *variabletypeName(variabletype_t vt)
 }
 
 
+/* Location of a variable during execution: the scope depth where it was
+ * declared (0 = global) and its slot index in the frame at that depth.
+ * Filled in by check().
+ */
+typedef struct location {
+	int depth;
+	int slot;
+} Location;
+
+
 /* Definition of a node in the abstract syntax tree describing a language
  * construct appearing in the source code. This is the key data structure
  * of the interpreter.
@@ -126,7 +138,8 @@ static inline char *variabletypeName(variabletype_t vt)
  * Assuming 'n' is a pointer to a node then the content of the anonymous union
  * can be accessed like this: n->block.statements.
  *
- * Every node includes pointers to functions to print, check or visit the node.
+ * Every node includes pointers to functions to print, check, visit or compile
+ * the node.
  *
  */
 typedef struct node {
@@ -152,6 +165,7 @@ typedef struct node {
 		struct {
 			variabletype_t type;
 			char *value;
+			struct object *constant;  /* immortal object with the value, created by check() */
 		} literal;
 
 		struct {
@@ -163,6 +177,7 @@ typedef struct node {
 			binaryoperator_t operator;
 			struct node *left;
 			struct node *right;
+			bool polymorphic;  /* operand types varied, do not quicken again */
 		} binary;
 
 		struct {
@@ -184,21 +199,31 @@ typedef struct node {
 			struct node *end;
 		} slice;
 
+		struct {  /* sequence[index] = expression, or a compound assignment */
+			assignmentoperator_t operator;  /* always ASSIGN for INDEX_STORE */
+			struct node *sequence;
+			struct node *index;
+			struct node *expression;
+		} index_store;
+
 		struct {
 			assignmentoperator_t operator;
 			struct node *variable;
 			struct node *expression;
+			bool polymorphic;  /* operand types varied, do not quicken again */
 		} assignment;
 
 		struct {
 			char *name;
+			Location location;
 		} reference;
 
 		struct {
 			char *name;
 			struct array *arguments;
 			bool builtin;  /* is this a builtin function */
-			bool checked;
+			struct node *declaration;  /* function declaration, NULL for builtins */
+			void (*address)(struct object *[], struct stack *);  /* builtin function, NULL for others */
 		} function_call;
 
 		struct {
@@ -208,8 +233,11 @@ typedef struct node {
 		struct {
 			char *name;
 			bool nested;  /* is this a nested function? */
-			struct array *arguments;
+			struct array *arguments;  /* occupy the first slots in the frame */
 			struct node *block;
+			int depth;  /* scope depth of the function body */
+			int slots;  /* frame size = number of arguments and local variables */
+			struct code *code;  /* compiled block, NULL if not compiled */
 		} function_declaration;
 
 		struct {
@@ -220,6 +248,8 @@ typedef struct node {
 			variabletype_t type;
 			char *name;
 			struct node *initialvalue;
+			Location location;
+			bool assigned;  /* is the variable assigned after its declaration, see optimize.c */
 		} defvar;
 
 		struct {
@@ -237,6 +267,8 @@ typedef struct node {
 			char *name;
 			struct node *expression;
 			struct node *block;
+			Location location;
+			bool range;  /* expression is a call of builtin range(), set by check() */
 		} for_stmnt;
 
 		struct {
@@ -256,14 +288,17 @@ typedef struct node {
 		struct {
 			struct array *prompts;
 			struct array *identifiers;
+			Location *locations;  /* one per identifier */
 		} input_stmnt;
 	};  /* anonymous unions require C11 */
 
 	void (*check)(struct node *);
 	void (*print)(struct node *, int);
 	void (*visit)(struct node *, struct stack *);
+	void (*compile)(struct node *, struct code *);
 } Node;
 
 Node *create(nodetype_t nt, ...);
+bool is_constant(Node *n);
 
 #endif
@@ -0,0 +1,714 @@
+/* compile.c
+ *
+ * Lower an abstract syntax tree to bytecode for the virtual machine in vm.c.
+ *
+ * Just like print(), check() and visit() compilation is implemented using
+ * a visitor pattern. Every node contains a pointer to its compile_...()
+ * function which appends the instructions for the node to a code object.
+ *
+ * The bytecode uses an operand stack. For every instruction its effect on
+ * the depth of this stack is known at compile time, so the maximum depth a
+ * code object requires can be calculated in advance. The virtual machine
+ * uses this to reserve the stack space it needs at once.
+ *
+ * The code is compiled after the checks in check() have been done. Any
+ * check done there is not repeated here.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "compile.h"
+#include "object.h"
+#include "config.h"
+#include "error.h"
+#include "visit.h"
+
+
+/* The break and continue statements of the loop which is being compiled.
+ *
+ * The jumps for break and continue are emitted before their destination
+ * is known. Unresolved jumps are chained together via their target field,
+ * ending with -1. When the destination becomes known the chain is patched.
+ */
+typedef struct loop {
+	struct loop *outer;		/* enclosing loop or NULL */
+	long continue_target;	/* instruction to continue at, -1 if not yet known */
+	long breaks;			/* chain of unresolved break jumps */
+	long continues;			/* chain of unresolved continue jumps */
+} Loop;
+
+static Loop *loop = NULL;	/* innermost loop being compiled */
+
+
+/* Create a new (empty) code object.
+ */
+static Code *code_alloc(void)
+{
+	Code *c;
+
+	if ((c = calloc(1, sizeof(Code))) == NULL)
+		raise(OutOfMemoryError);
+
+	return c;
+}
+
+
+/* Operand stack effect of an instruction.
+ */
+static long stack_effect(opcode_t opcode, long arg)
+{
+	switch (opcode) {
+		case OP_CONST:
+		case OP_LOAD:
+		case OP_LOAD_TARGET:
+			return 1;
+		case OP_DEFVAR:
+			return arg ? 1 : 0;  /* arg is true if the variable is initialized */
+		case OP_POP:
+		case OP_BINARY:
+		case OP_ASSIGN:
+		case OP_INDEX:
+		case OP_JUMP_FALSE:
+		case OP_PRINT:
+		case OP_RETURN:
+			return -1;
+		case OP_INIT:
+		case OP_STORE_INDEX:
+		case OP_UPDATE_INDEX:
+		case OP_SLICE:
+		case OP_COMPARE_JUMP:
+			return -2;
+		case OP_LIST:
+		case OP_CALL:
+		case OP_BUILTIN:
+			return 1 - arg;  /* arg = number of arguments */
+		case OP_METHOD:
+			return -arg;
+		case OP_FOR_END:
+			return -1;
+		default:
+			return 0;
+	}
+}
+
+
+/* Append an instruction to a code object.
+ *
+ * c		code object
+ * opcode	instruction to add
+ * arg		operator, argument count or flag
+ * operand	constant object, name or node
+ * return	index of the new instruction
+ */
+static size_t emit(Code *c, opcode_t opcode, long arg, void *operand)
+{
+	Instruction *i;
+
+	if (c->size == c->capacity) {
+		c->capacity = c->capacity ? c->capacity * 2 : 32;
+		if ((c->instr = realloc(c->instr, c->capacity * sizeof(Instruction))) == NULL)
+			raise(OutOfMemoryError);
+	}
+
+	i = &c->instr[c->size];
+
+	i->label = NULL;
+	i->opcode = opcode;
+	i->arg = arg;
+	i->target = -1;
+	i->depth = 0;
+	i->operand = operand;
+	i->node = current_node;
+
+	c->depth += stack_effect(opcode, arg);
+	if (c->depth > c->maxdepth)
+		c->maxdepth = c->depth;
+
+	return c->size++;
+}
+
+
+/* Append an instruction which accesses the variable at 'location'.
+ *
+ * return	index of the new instruction
+ */
+static size_t emit_variable(Code *c, opcode_t opcode, Location location, void *operand)
+{
+	size_t index = emit(c, opcode, location.slot, operand);
+
+	c->instr[index].depth = location.depth;
+
+	return index;
+}
+
+
+/* Set the destination of jump instruction at index 'jump' to the next
+ * instruction to be emitted.
+ */
+static void patch(Code *c, size_t jump)
+{
+	c->instr[jump].target = c->size;
+}
+
+
+/* Set the destination of all jumps in a chain to 'target'.
+ */
+static void patch_chain(Code *c, long chain, long target)
+{
+	long next;
+
+	while (chain >= 0) {
+		next = c->instr[chain].target;
+		c->instr[chain].target = target;
+		chain = next;
+	}
+}
+
+
+/* Add a jump to 'target'. The index is stored before the instruction is
+ * accessed as emit() can move c->instr.
+ */
+static void emit_jump(Code *c, long target)
+{
+	size_t jump = emit(c, OP_JUMP, 0, NULL);
+
+	c->instr[jump].target = target;
+}
+
+
+/* Add an unresolved jump to a chain.
+ */
+static void emit_chained_jump(Code *c, long *chain)
+{
+	size_t jump = emit(c, OP_JUMP, 0, NULL);
+
+	c->instr[jump].target = *chain;
+	*chain = jump;
+}
+
+
+/* Is this a binary operator which compares its operands?
+ */
+static bool is_comparison(binaryoperator_t operator)
+{
+	switch (operator) {
+		case LSS:
+		case LEQ:
+		case GTR:
+		case GEQ:
+		case EQ:
+		case NEQ:
+			return true;
+		default:
+			return false;
+	}
+}
+
+
+/* Compile a condition followed by a jump which is taken if the
+ * condition is false. A comparison is fused with the jump into a
+ * single instruction.
+ *
+ * return	index of the jump instruction, to be patched by the caller
+ */
+static size_t compile_condition(Node *n, Code *c)
+{
+	size_t jump;
+
+	if (n->type == BINARY && n->method.valid == false && is_comparison(n->binary.operator)) {
+		Node *tmp = current_node;
+		current_node = n;
+
+		compile(n->binary.left, c);
+		compile(n->binary.right, c);
+		jump = emit(c, OP_COMPARE_JUMP, n->binary.operator, NULL);
+
+		current_node = tmp;
+	} else {
+		compile(n, c);
+		jump = emit(c, OP_JUMP_FALSE, 0, NULL);
+	}
+	return jump;
+}
+
+
+/* API: Compile a node.
+ *
+ * Appends the instructions for node n to code object c. Each node is
+ * responsible for compiling its child nodes (if any).
+ *
+ * n		node to compile
+ * c		code object to append the instructions to
+ */
+void compile(Node *n, Code *c)
+{
+	Node *tmp = current_node;
+	current_node = n;
+
+	n->compile(n, c);
+
+	if (n->method.valid) {
+		for (size_t i = 0; i < n->method.arguments->size; i++)
+			compile(n->method.arguments->element[i], c);
+
+		emit(c, OP_METHOD, n->method.arguments->size, n->method.name);
+	}
+
+	current_node = tmp;
+}
+
+
+/* API: Compile the top level module.
+ *
+ * root		root node of the AST
+ * return	code object, ends with a HALT instruction
+ */
+Code *compile_module(Node *root)
+{
+	Code *c = code_alloc();
+
+	compile(root, c);
+	emit(c, OP_HALT, 0, NULL);
+
+	#ifdef DEBUG
+	if (config.debug & DEBUGBYTECODE)
+		print_code(c, "module");
+	#endif  /* DEBUG */
+
+	return c;
+}
+
+
+/* For every nodetype a compile_...() function is defined below. Just like
+ * the functions in visit.c these have global scope because the pointers
+ * to them are assigned in ast.c.
+ */
+
+
+void compile_block(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->block.statements->size; i++)
+		compile(n->block.statements->element[i], c);
+}
+
+
+void compile_literal(Node *n, Code *c)
+{
+	emit(c, OP_CONST, 0, n->literal.constant);  /* immortal constant created by check() */
+}
+
+
+void compile_unary(Node *n, Code *c)
+{
+	compile(n->unary.operand, c);
+
+	if (n->unary.operator != UPLUS)
+		emit(c, OP_UNARY, n->unary.operator, NULL);
+}
+
+
+/* For 'and' and 'or' the right operand is skipped if the left operand
+ * already determines the result (short-circuit evaluation).
+ */
+void compile_binary(Node *n, Code *c)
+{
+	size_t jump = 0;
+	bool logical = n->binary.operator == LOGICAL_AND || n->binary.operator == LOGICAL_OR;
+
+	compile(n->binary.left, c);
+
+	if (logical)
+		jump = emit(c, OP_JUMP_LOGICAL, n->binary.operator, NULL);
+
+	compile(n->binary.right, c);
+
+	emit(c, OP_BINARY, n->binary.operator, NULL);
+
+	if (logical)
+		patch(c, jump);
+}
+
+
+void compile_comma_expr(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->comma_expr.expressions->size; i++) {
+		compile(n->comma_expr.expressions->element[i], c);
+		if (i != n->comma_expr.expressions->size - 1)
+			emit(c, OP_POP, 0, NULL);  /* only result from last expression is used */
+	}
+}
+
+
+void compile_arglist(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->arglist.arguments->size; i++)
+		compile(n->arglist.arguments->element[i], c);
+
+	emit(c, OP_LIST, n->arglist.arguments->size, NULL);
+}
+
+
+void compile_index(Node *n, Code *c)
+{
+	compile(n->index.sequence, c);
+	compile(n->index.index, c);
+
+	emit(c, OP_INDEX, 0, NULL);
+}
+
+
+void compile_slice(Node *n, Code *c)
+{
+	compile(n->slice.sequence, c);
+	compile(n->slice.start, c);
+	compile(n->slice.end, c);
+
+	emit(c, OP_SLICE, 0, NULL);
+}
+
+
+void compile_index_store(Node *n, Code *c)
+{
+	compile(n->index_store.sequence, c);
+	compile(n->index_store.index, c);
+	compile(n->index_store.expression, c);
+
+	emit(c, OP_STORE_INDEX, 0, NULL);
+}
+
+
+void compile_index_update(Node *n, Code *c)
+{
+	compile(n->index_store.sequence, c);
+	compile(n->index_store.index, c);
+	compile(n->index_store.expression, c);
+
+	emit(c, OP_UPDATE_INDEX, n->index_store.operator, NULL);
+}
+
+
+/* A variable as target is loaded via LOAD_TARGET, which does not replace
+ * the listnode of a for-in loop variable by the list element.
+ */
+void compile_assignment(Node *n, Code *c)
+{
+	Node *variable = n->assignment.variable;
+
+	if (variable->type == REFERENCE && variable->method.valid == false)
+		emit_variable(c, OP_LOAD_TARGET, variable->reference.location, variable->reference.name);
+	else
+		compile(variable, c);
+
+	if (is_constant(n->assignment.variable))
+		emit(c, OP_COPY, 0, NULL);
+
+	compile(n->assignment.expression, c);
+
+	emit(c, OP_ASSIGN, n->assignment.operator, NULL);
+}
+
+
+void compile_reference(Node *n, Code *c)
+{
+	emit_variable(c, OP_LOAD, n->reference.location, n->reference.name);
+}
+
+
+void compile_function_call(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->function_call.arguments->size; i++)
+		compile(n->function_call.arguments->element[i], c);
+
+	if (n->function_call.builtin == true)
+		emit(c, OP_BUILTIN, n->function_call.arguments->size, n);
+	else
+		emit(c, OP_CALL, n->function_call.arguments->size, n->function_call.declaration);
+}
+
+
+void compile_expression_stmnt(Node *n, Code *c)
+{
+	compile(n->expression_stmnt.expression, c);
+
+	emit(c, OP_POP, 0, NULL);  /* expression statements do not have a result */
+}
+
+
+/* A function body is compiled into its own code object which is
+ * stored in the declaration node. As calls are resolved by check()
+ * the declaration itself does not result in any instructions.
+ */
+void compile_function_declaration(Node *n, Code *c)
+{
+	Loop *outer = loop;
+	Code *body = code_alloc();
+
+	loop = NULL;  /* break and continue cannot cross function boundaries */
+
+	compile(n->function_declaration.block, body);
+
+	/* result if the function did not end with a RETURN statement */
+	emit(body, OP_CONST, 0, obj_int((int_t)0));
+	emit(body, OP_RETURN, 0, NULL);
+
+	loop = outer;
+
+	n->function_declaration.code = body;
+
+	#ifdef DEBUG
+	if (config.debug & DEBUGBYTECODE)
+		print_code(body, n->function_declaration.name);
+	#endif  /* DEBUG */
+
+	UNUSED(c);
+}
+
+
+void compile_variable_declaration(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->variable_declaration.defvars->size; i++)
+		compile(n->variable_declaration.defvars->element[i], c);
+}
+
+
+void compile_defvar(Node *n, Code *c)
+{
+	if (n->defvar.initialvalue) {
+		emit(c, OP_DEFVAR, true, n);
+		compile(n->defvar.initialvalue, c);
+		emit(c, OP_INIT, 0, NULL);
+	} else
+		emit(c, OP_DEFVAR, false, n);
+}
+
+
+void compile_if_stmnt(Node *n, Code *c)
+{
+	size_t jump_false, jump_end;
+
+	jump_false = compile_condition(n->if_stmnt.condition, c);
+
+	compile(n->if_stmnt.consequent, c);
+
+	if (n->if_stmnt.alternative) {
+		jump_end = emit(c, OP_JUMP, 0, NULL);
+		patch(c, jump_false);
+		compile(n->if_stmnt.alternative, c);
+		patch(c, jump_end);
+	} else
+		patch(c, jump_false);
+}
+
+
+void compile_while_stmnt(Node *n, Code *c)
+{
+	size_t start = c->size, jump_false;
+	Loop this = { .outer = loop, .continue_target = start, .breaks = -1, .continues = -1 };
+
+	jump_false = compile_condition(n->loop_stmnt.condition, c);
+
+	loop = &this;
+	compile(n->loop_stmnt.block, c);
+	loop = this.outer;
+
+	emit_jump(c, start);
+
+	patch(c, jump_false);
+	patch_chain(c, this.breaks, c->size);
+}
+
+
+void compile_do_stmnt(Node *n, Code *c)
+{
+	size_t start = c->size, jump_false;
+	Loop this = { .outer = loop, .continue_target = -1, .breaks = -1, .continues = -1 };
+
+	loop = &this;
+	compile(n->loop_stmnt.block, c);
+	loop = this.outer;
+
+	patch_chain(c, this.continues, c->size);
+
+	jump_false = compile_condition(n->loop_stmnt.condition, c);
+	emit_jump(c, start);
+
+	patch(c, jump_false);
+	patch_chain(c, this.breaks, c->size);
+}
+
+
+/* While the loop executes the sequence, its length and the index of
+ * the next item are kept on the operand stack.
+ */
+void compile_for_stmnt(Node *n, Code *c)
+{
+	size_t next;
+	Loop this = { .outer = loop, .continue_target = -1, .breaks = -1, .continues = -1 };
+
+	emit_variable(c, OP_FOR_PREP, n->for_stmnt.location, n->for_stmnt.name);
+	compile(n->for_stmnt.expression, c);
+	emit(c, OP_FOR_INIT, 0, NULL);
+
+	/* a loop over a direct call of range() calculates the items itself */
+	next = emit_variable(c, n->for_stmnt.range ? OP_FOR_RANGE : OP_FOR_NEXT, n->for_stmnt.location, n->for_stmnt.name);
+
+	this.continue_target = next;
+	loop = &this;
+	compile(n->for_stmnt.block, c);
+	loop = this.outer;
+
+	emit_jump(c, next);
+
+	patch(c, next);
+	patch_chain(c, this.breaks, c->size);
+
+	emit(c, OP_FOR_END, 0, NULL);
+}
+
+
+void compile_print_stmnt(Node *n, Code *c)
+{
+	for (size_t i = 0; i != n->print_stmnt.expressions->size; i++) {
+		if (i != 0 && n->print_stmnt.raw == false)
+			emit(c, OP_PRINT_SPACE, 0, NULL);
+
+		compile(n->print_stmnt.expressions->element[i], c);
+		emit(c, OP_PRINT, 0, NULL);
+	}
+
+	if (n->print_stmnt.raw == false)
+		emit(c, OP_PRINT_NEWLINE, 0, NULL);
+}
+
+
+void compile_return_stmnt(Node *n, Code *c)
+{
+	if (n->return_stmnt.value == NULL)
+		emit(c, OP_CONST, 0, obj_int((int_t)0));
+	else {
+		compile(n->return_stmnt.value, c);
+		if (is_constant(n->return_stmnt.value))
+			emit(c, OP_COPY, 0, NULL);  /* the caller may use the result as assignment target */
+	}
+
+	emit(c, OP_RETURN, 0, NULL);
+}
+
+
+void compile_import_stmnt(Node *n, Code *c)
+{
+	compile(n->import_stmnt.code, c);
+}
+
+
+void compile_input_stmnt(Node *n, Code *c)
+{
+	emit(c, OP_INPUT, 0, n);
+}
+
+
+void compile_pass_stmnt(Node *n, Code *c)
+{
+	UNUSED(n);
+	UNUSED(c);
+}
+
+
+void compile_break_stmnt(Node *n, Code *c)
+{
+	UNUSED(n);
+
+	if (loop == NULL)
+		raise(SyntaxError, "break outside loop");
+
+	emit_chained_jump(c, &loop->breaks);
+}
+
+
+void compile_continue_stmnt(Node *n, Code *c)
+{
+	UNUSED(n);
+
+	if (loop == NULL)
+		raise(SyntaxError, "continue outside loop");
+
+	if (loop->continue_target >= 0)
+		emit_jump(c, loop->continue_target);
+	else
+		emit_chained_jump(c, &loop->continues);
+}
+
+
+#ifdef DEBUG
+/* Print the instructions in a code object.
+ *
+ * c		code object to print
+ * title	name of the module or function the code belongs to
+ */
+void print_code(Code *c, const char *title)
+{
+	Instruction *i;
+
+	printf("code %s, %zu instructions, max stack depth %ld\n", title, c->size, c->maxdepth);
+
+	for (size_t index = 0; index != c->size; index++) {
+		i = &c->instr[index];
+
+		printf("%5zu %-14s", index, opcodeName(i->opcode));
+
+		switch (i->opcode) {
+			case OP_CONST:
+				obj_print(stdout, i->operand);
+				break;
+			case OP_LOAD:
+			case OP_LOAD_TARGET:
+			case OP_FOR_PREP:
+				printf("%s (%d:%ld)", (char *)i->operand, i->depth, i->arg);
+				break;
+			case OP_METHOD:
+				printf("%s", (char *)i->operand);
+				break;
+			case OP_CALL:
+				printf("%s %ld", ((Node *)i->operand)->function_declaration.name, i->arg);
+				break;
+			case OP_BUILTIN:
+				printf("%s %ld", ((Node *)i->operand)->function_call.name, i->arg);
+				break;
+			case OP_DEFVAR:
+				printf("%s (%d:%d)", ((Node *)i->operand)->defvar.name, \
+									 ((Node *)i->operand)->defvar.location.depth, ((Node *)i->operand)->defvar.location.slot);
+				break;
+			case OP_UNARY:
+				printf("%s", unaryoperatorName(i->arg));
+				break;
+			case OP_BINARY:
+				printf("%s", binaryoperatorName(i->arg));
+				break;
+			case OP_ASSIGN:
+			case OP_UPDATE_INDEX:
+				printf("%s", assignmentoperatorName(i->arg));
+				break;
+			case OP_LIST:
+				printf("%ld", i->arg);
+				break;
+			case OP_COMPARE_JUMP:
+				printf("%s -> %ld", binaryoperatorName(i->arg), i->target);
+				break;
+			case OP_JUMP:
+			case OP_JUMP_FALSE:
+				printf("-> %ld", i->target);
+				break;
+			case OP_JUMP_LOGICAL:
+				printf("%s -> %ld", binaryoperatorName(i->arg), i->target);
+				break;
+			case OP_FOR_NEXT:
+			case OP_FOR_RANGE:
+				printf("%s (%d:%ld) -> %ld", (char *)i->operand, i->depth, i->arg, i->target);
+				break;
+			default:
+				break;
+		}
+		printf("\n");
+	}
+}
+#endif  /* DEBUG */
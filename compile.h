@@ -0,0 +1,79 @@
+/* compile.h
+ *
+ * Data structures for the bytecode which is produced by lowering the
+ * abstract syntax tree. The bytecode is executed by the virtual machine
+ * in vm.c.
+ */
+#ifndef _COMPILE_
+#define _COMPILE_
+
+#include <stdbool.h>
+#include "ast.h"
+
+
+/* All possible opcodes.
+ */
+typedef enum { OP_HALT=0, OP_POP, OP_CONST, OP_COPY, OP_LOAD, OP_LOAD_TARGET, OP_DEFVAR, OP_INIT, OP_UNARY,
+			   OP_BINARY, OP_ASSIGN, OP_INDEX, OP_STORE_INDEX, OP_UPDATE_INDEX, OP_SLICE, OP_LIST,
+			   OP_CALL, OP_BUILTIN, OP_METHOD,
+			   OP_JUMP, OP_JUMP_FALSE, OP_JUMP_LOGICAL, OP_COMPARE_JUMP, OP_FOR_PREP, OP_FOR_INIT, OP_FOR_NEXT,
+			   OP_FOR_RANGE, OP_FOR_END, OP_PRINT, OP_PRINT_SPACE, OP_PRINT_NEWLINE, OP_INPUT, OP_RETURN } opcode_t;
+
+/* Printable name for every opcode.
+ */
+static inline char *opcodeName(opcode_t op)
+{
+	static char *string[] = {
+		"HALT", "POP", "CONST", "COPY", "LOAD", "LOAD_TARGET", "DEFVAR", "INIT", "UNARY",
+		"BINARY", "ASSIGN", "INDEX", "STORE_INDEX", "UPDATE_INDEX", "SLICE", "LIST",
+		"CALL", "BUILTIN", "METHOD",
+		"JUMP", "JUMP_FALSE", "JUMP_LOGICAL", "COMPARE_JUMP", "FOR_PREP", "FOR_INIT", "FOR_NEXT",
+		"FOR_RANGE", "FOR_END", "PRINT", "PRINT_SPACE", "PRINT_NEWLINE", "INPUT", "RETURN"
+	};
+
+	if (op < 0 || op > (sizeof(string) / sizeof(string[0]) - 1))
+		return "?";  /* out of bound values */
+
+	return string[op];
+}
+
+
+/* A single bytecode instruction.
+ *
+ * Which of the fields arg, target, depth and operand are used depends on
+ * the opcode. Instructions which access a variable keep its slot index in
+ * arg and its scope depth in depth. Field label is filled in by the virtual
+ * machine the first time the code is executed (see 'threaded' in struct
+ * code).
+ */
+typedef struct instruction {
+	void *label;		/* address of the opcode handler in the virtual machine */
+	opcode_t opcode;
+	long arg;			/* operator, argument count, flag or slot index */
+	long target;		/* index of the instruction to jump to */
+	int depth;			/* scope depth of a variable */
+	void *operand;		/* constant object, name or node */
+	struct node *node;	/* node this instruction was compiled from, for error reporting */
+} Instruction;
+
+
+/* A sequence of instructions. The top level module code and every
+ * function body are compiled into a separate code object.
+ */
+typedef struct code {
+	Instruction *instr;	/* array with instructions */
+	size_t size;		/* number of instructions in use */
+	size_t capacity;	/* number of instructions which fit in instr */
+	long depth;			/* operand stack depth while compiling */
+	long maxdepth;		/* maximum operand stack depth required when executing */
+	bool threaded;		/* are the instruction labels filled in? */
+} Code;
+
+extern Code *compile_module(Node *root);
+extern void compile(Node *n, Code *c);
+
+#ifdef DEBUG
+extern void print_code(Code *c, const char *title);
+#endif  /* DEBUG */
+
+#endif
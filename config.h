@@ -12,6 +12,7 @@
 #define LANGUAGE	"EXIN"
 #define VERSION		"2.05"
 #define TABSIZE		4		/* default spaces per tab */
+#define OPTIMIZE	1		/* default optimization level */
 
 /* Constants which are used to define the size of
  * arrays which are created at compile time
@@ -37,6 +38,8 @@ typedef double float_t;		/* basic type for FLOAT_T */
 typedef struct {
 	int debug;      /* debug logging level */
 	int tabsize;    /* spaces per tab */
+	int bytecode;   /* execute via the bytecode virtual machine instead of visit() */
+	int optimize;   /* optimization level */
 } Config;
 
 extern Config config;
@@ -68,6 +71,7 @@ extern Config config;
 #define DEBUGASTEXEC    8	/* print AST and execute */
 #define DEBUGDUMP       16	/* dump identifiers and objects to stdout */
 #define DEBUGDUMPFILE   32	/* dump identifiers and objects to file */
+#define DEBUGBYTECODE   64	/* show bytecode after compilation */
 
 /* This macro is used to suppress 'unused argument' warnings during compilation.
  */
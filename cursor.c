@@ -0,0 +1,90 @@
+/* cursor.c
+ *
+ * Cursor object operations.
+ *
+ * The type of the sequence determines how a cursor moves over it. When a
+ * cursor is created the begin() function of the type object of the
+ * sequence initializes the cursor. Then the next() function of the type
+ * object returns the items one by one. The number of items is determined
+ * only once, so iterating over n items costs O(n).
+ */
+#include "error.h"
+#include "cursor.h"
+#include "pool.h"
+
+
+/* Create a new cursor, which does not yet refer to a sequence.
+ *
+ * return	new cursor-object or NULL in case of error
+ */
+static CursorObject *cursor_alloc(void)
+{
+	CursorObject *obj;
+
+	if ((obj = pool_alloc(sizeof(CursorObject))) != NULL) {
+		obj->typeobj = (TypeObject *)&cursortype;
+		obj->type = CURSOR_T;
+		obj->refcount = 0;
+
+		obj->sequence = NULL;
+		obj->index = 0;
+		obj->end = 0;
+	}
+	return obj;  /* returns NULL if alloc failed */
+}
+
+
+/* Free a cursor, and release the sequence it iterates over.
+ *
+ */
+static void cursor_free(CursorObject *cursor)
+{
+	if (cursor->sequence)
+		obj_decref(cursor->sequence);
+
+	*cursor = (const CursorObject) { 0 };  /* clear the object struct, facilitates debugging */
+
+	pool_free(cursor, sizeof(CursorObject));
+}
+
+
+static void cursor_print(FILE *fp, CursorObject *cursor)
+{
+	fprintf(fp, "cursor %ld of %ld", (long)cursor->index, (long)cursor->end);
+}
+
+
+/* Let a new cursor point to the first item of a sequence.
+ *
+ * argp		sequence to iterate over, its type must support begin() and next()
+ */
+static void cursor_vset(CursorObject *cursor, va_list argp)
+{
+	cursor->sequence = va_arg(argp, Object *);
+
+	obj_incref(cursor->sequence);
+
+	TYPEOBJ(cursor->sequence)->begin(cursor->sequence, cursor);
+}
+
+
+static Object *cursor_method(CursorObject *obj, char *name, Array *arguments)
+{
+	UNUSED(arguments);
+
+	raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
+
+	return obj_alloc(NONE_T);
+}
+
+
+/* Cursor object API.
+ */
+CursorType cursortype = {
+	.name = "cursor",
+	.alloc = (Object *(*)())cursor_alloc,
+	.free = (void (*)(Object *))cursor_free,
+	.print = (void (*)(FILE *, Object *))cursor_print,
+	.vset = (void (*)(Object *, va_list))cursor_vset,
+	.method = (Object *(*)(Object *, char *, Array *))cursor_method
+	};
@@ -0,0 +1,25 @@
+/* cursor.h
+ *
+ * A cursor keeps track of the position while iterating over a sequence,
+ * for example by a for-in loop. It is created by obj_iterate(), and every
+ * call of obj_next() returns the next item (see object.c).
+ */
+#ifndef _CURSOR_
+#define _CURSOR_
+
+#include "object.h"
+
+typedef struct cursor {
+	OBJ_HEAD;
+	Object *sequence;	/* sequence which is iterated */
+	int_t index;		/* position of the next item */
+	int_t end;			/* number of items, set by begin() of the sequence */
+} CursorObject;
+
+typedef struct {
+	TYPE_HEAD;
+} CursorType;
+
+extern CursorType cursortype;
+
+#endif
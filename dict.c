@@ -0,0 +1,928 @@
+/* dict.c
+ *
+ * Dict object operations
+ *
+ * See dict.h for an explanation on the data structures for dicts.
+ *
+ * The slot for a key is found by probing: starting at the slot indicated
+ * by the lowest bits of the hash value, a sequence of slots is visited
+ * until the key or an empty slot is found. The higher bits of the hash
+ * value are gradually mixed into the sequence, so keys whose hash values
+ * only differ in the higher bits soon take different paths. When a key
+ * is removed its slot is marked as REMOVED instead of emptied, so the
+ * probe sequences which pass this slot are not cut short. At most two
+ * thirds of the slots are in use, so on average a key is found after a
+ * few probes and a lookup costs O(1). When the table is full it is
+ * replaced by a larger one, which also drops the REMOVED slots.
+ *
+ * Keys are equal if they have the same type and value. A dict holds its
+ * own copies of the keys and values. Keys are never modified, so copies of
+ * a dict share the key objects.
+ *
+ * Sets use the same functions. As the hash values are stored in the
+ * slots, union, intersection and difference compare keys from one table
+ * with another without hashing them again.
+ */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "object.h"
+#include "error.h"
+#include "none.h"
+#include "number.h"
+#include "str.h"
+#include "list.h"
+#include "dict.h"
+#include "cursor.h"
+
+
+#define DICTMINSIZE		8	/* minimal number of slots */
+#define PERTURBSHIFT	5	/* number of bits of the hash value to mix in per probe */
+
+static Object removed;		/* key of a slot whose key was removed */
+
+#define REMOVED			(&removed)
+#define isUsed(entry)	((entry)->key != NULL && (entry)->key != REMOVED)
+
+
+/* Create a new empty dict-object.
+ *
+ * return	new dict-object or NULL in case of error
+ */
+static DictObject *dict_alloc(void)
+{
+	DictObject *obj;
+
+	if ((obj = calloc(1, sizeof(DictObject))) != NULL) {
+		obj->typeobj = (TypeObject *)&dicttype;
+		obj->type = DICT_T;
+		obj->refcount = 0;
+
+		obj->size = 0;
+		obj->fill = 0;
+		obj->mask = 0;
+		obj->slot = NULL;
+	}
+	return obj;  /* returns NULL if alloc failed */
+}
+
+
+/* Release all keys and values in a dict, and the array with slots.
+ */
+static void clear(DictObject *dict)
+{
+	if (dict->slot) {
+		for (int_t i = 0; i <= dict->mask; i++)
+			if (isUsed(&dict->slot[i])) {
+				obj_decref(dict->slot[i].key);
+				if (dict->slot[i].value)  /* sets have no values */
+					obj_decref(dict->slot[i].value);
+			}
+		free(dict->slot);
+	}
+
+	dict->slot = NULL;
+	dict->size = 0;
+	dict->fill = 0;
+	dict->mask = 0;
+}
+
+
+/* Free a dict-object, and release the keys and values it holds.
+ *
+ */
+static void dict_free(DictObject *dict)
+{
+	clear(dict);
+
+	*dict = (const DictObject) { 0 };  /* clear the object struct, facilitates debugging */
+
+	free(dict);
+}
+
+
+/* Print dict content between curly brackets.
+ *
+ */
+static void dict_print(FILE *fp, DictObject *dict)
+{
+	int_t count = 0;
+
+	fprintf(fp, "{");
+
+	for (int_t i = 0; dict->slot && i <= dict->mask; i++)
+		if (isUsed(&dict->slot[i])) {
+			obj_print(fp, dict->slot[i].key);
+			fprintf(fp, ":");
+			obj_print(fp, dict->slot[i].value);
+			if (++count < dict->size)
+				fprintf(fp, ",");
+		}
+
+	fprintf(fp, "}");
+}
+
+
+/* Calculate the hash value of a key. Only numbers and strings can be
+ * used as key. Hash values of strings are cached, see str.c.
+ *
+ * return	hash value
+ */
+static size_t hash_of(Object *key)
+{
+	size_t hash;
+	float_t f;
+
+	switch (TYPE(key)) {
+		case CHAR_T:
+			hash = (size_t)char_value(key);
+			break;
+		case INT_T:
+			hash = (size_t)int_value(key);
+			break;
+		case FLOAT_T:
+			f = ((FloatObject *)key)->fval;
+			if (f == 0.0)
+				f = 0.0;  /* -0.0 and 0.0 are the same key */
+			hash = 0;
+			memcpy(&hash, &f, sizeof(f) < sizeof(hash) ? sizeof(f) : sizeof(hash));
+			break;
+		case STR_T:
+			return strtype.hash((StrObject *)key);
+		default:
+			raise(TypeError, "type %s cannot be used as key", TYPENAME(key));
+			return 0;
+	}
+
+	/* spread the bits of a number, so numbers which are a multiple of the
+	 * number of slots do not all start probing at the same slot */
+	hash ^= hash >> 33;
+	hash *= (size_t)0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+
+/* Check if two keys are equal.
+ */
+static bool equal(Object *key1, Object *key2)
+{
+	if (TYPE(key1) != TYPE(key2))
+		return false;
+
+	switch (TYPE(key1)) {
+		case CHAR_T:
+			return char_value(key1) == char_value(key2);
+		case INT_T:
+			return int_value(key1) == int_value(key2);
+		case FLOAT_T:
+			return ((FloatObject *)key1)->fval == ((FloatObject *)key2)->fval;
+		case STR_T:
+			return ((StrObject *)key1)->length == ((StrObject *)key2)->length && \
+				   memcmp(((StrObject *)key1)->sptr, ((StrObject *)key2)->sptr, ((StrObject *)key1)->length) == 0;
+		default:
+			return false;
+	}
+}
+
+
+/* Raise the error for a key which is not in a dict.
+ */
+static void missing(Object *key)
+{
+	StrObject *s = (StrObject *)obj_to_strobj(key);
+
+	raise(KeyError, "key %s not found", s->sptr);
+
+	obj_decref(s);
+}
+
+
+/* Find the slot for a key.
+ *
+ * The dict must have an array with slots.
+ *
+ * return	slot holding the key or, if the key is not in the dict, the
+ *			slot where it should be added
+ */
+static DictEntry *lookup(DictObject *dict, Object *key, size_t hash)
+{
+	DictEntry *entry, *available = NULL;
+
+	for (size_t perturb = hash, i = hash & dict->mask;; perturb >>= PERTURBSHIFT, i = (i * 5 + perturb + 1) & dict->mask) {
+		entry = &dict->slot[i];
+
+		if (entry->key == NULL)
+			return available ? available : entry;
+
+		if (entry->key == REMOVED) {
+			if (available == NULL)
+				available = entry;  /* first REMOVED slot can be reused */
+		} else if (entry->hash == hash && equal(entry->key, key))
+			return entry;
+	}
+}
+
+
+/* Find the first empty slot for a hash value. Used when building a new
+ * table, which does not contain REMOVED slots nor equal keys.
+ */
+static DictEntry *empty_slot(DictObject *dict, size_t hash)
+{
+	DictEntry *entry;
+
+	for (size_t perturb = hash, i = hash & dict->mask;; perturb >>= PERTURBSHIFT, i = (i * 5 + perturb + 1) & dict->mask)
+		if ((entry = &dict->slot[i])->key == NULL)
+			return entry;
+}
+
+
+/* Give a dict a new empty array with enough slots for 'size' keys,
+ * filled for at most one third. The old array is left to the caller.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool allocate(DictObject *dict, int_t size)
+{
+	DictEntry *slot;
+	int_t capacity = DICTMINSIZE;
+
+	while (capacity < size * 3)
+		capacity *= 2;
+
+	if ((slot = calloc(capacity, sizeof(DictEntry))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	dict->slot = slot;
+	dict->mask = capacity - 1;
+	dict->fill = 0;
+
+	return true;
+}
+
+
+/* Move the keys and values to a new array with room for at least one
+ * more key. The stored hash values are reused, no key is hashed again.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool resize(DictObject *dict)
+{
+	DictEntry *old = dict->slot;
+	int_t count = old ? dict->mask + 1 : 0;
+
+	if (allocate(dict, dict->size + 1) == false) {
+		dict->slot = old;
+		return false;
+	}
+
+	for (int_t i = 0; i < count; i++)
+		if (isUsed(&old[i]))
+			*empty_slot(dict, old[i].hash) = old[i];
+
+	dict->fill = dict->size;
+
+	free(old);
+
+	return true;
+}
+
+
+/* Find the slot which holds a key.
+ *
+ * return	slot or NULL if the key is not in the dict
+ */
+static DictEntry *find(DictObject *dict, Object *key)
+{
+	DictEntry *entry;
+
+	if (dict->size == 0)
+		return NULL;
+
+	entry = lookup(dict, key, hash_of(key));
+
+	return isUsed(entry) ? entry : NULL;
+}
+
+
+/* Copy the content of dict 'src' to dict 'dest'.
+ *
+ * The keys are shared, the values are copied.
+ *
+ * dest		destination dict
+ * src		source dict
+ */
+static void dict_set(DictObject *dest, DictObject *src)
+{
+	DictEntry *entry;
+
+	if (dest == src)
+		return;
+
+	obj_incref(src);  /* src may be held by dest */
+
+	clear(dest);
+
+	if (src->size && allocate(dest, src->size) == true) {
+		for (int_t i = 0; i <= src->mask; i++)
+			if (isUsed(&src->slot[i])) {
+				entry = empty_slot(dest, src->slot[i].hash);
+				entry->key = src->slot[i].key;
+				obj_incref(entry->key);
+				entry->value = obj_copy(src->slot[i].value);
+				entry->hash = src->slot[i].hash;
+			}
+		dest->size = dest->fill = src->size;
+	}
+
+	obj_decref(src);
+}
+
+
+static void dict_vset(DictObject *obj, va_list argp)
+{
+	dict_set(obj, va_arg(argp, DictObject *));
+}
+
+
+/* Return key count as an integer-object.
+ *
+ * return	integer-object with count or none-object in case of error
+ */
+static Object *dict_length(DictObject *dict)
+{
+	Object *len;
+
+	if ((len = obj_int(dict->size)) == NULL)
+		len = obj_alloc(NONE_T);
+
+	return len;
+}
+
+
+/* Retrieve the value for a key.
+ *
+ * Note: The refcount of the value is increased by 1.
+ *
+ * return	value or none-object if the key is not in the dict
+ */
+static Object *dict_item(DictObject *dict, Object *key)
+{
+	DictEntry *entry;
+
+	if ((entry = find(dict, key)) == NULL) {
+		missing(key);
+		return obj_alloc(NONE_T);
+	}
+
+	obj_incref(entry->value);
+
+	return entry->value;
+}
+
+
+/* Find the slot for a key, and add the key if it is not yet present.
+ *
+ * dict		dict or set
+ * key		key to add
+ * hash		hash value of key
+ * share	if true key is held by another dict or set and can be shared,
+ *			else a copy of key is added
+ * return	slot holding the key, its value is NULL for a new key, or NULL
+ *			if out of memory
+ */
+static DictEntry *insert(DictObject *dict, Object *key, size_t hash, bool share)
+{
+	DictEntry *entry;
+
+	if (dict->slot == NULL || (dict->fill + 1) * 3 > (dict->mask + 1) * 2)
+		if (resize(dict) == false)
+			return NULL;
+
+	entry = lookup(dict, key, hash);
+
+	if (isUsed(entry))
+		return entry;
+
+	if (entry->key == NULL)
+		dict->fill++;
+
+	if (share)
+		obj_incref(key);
+
+	entry->key = share ? key : obj_copy(key);
+	entry->value = NULL;
+	entry->hash = hash;
+
+	dict->size++;
+
+	return entry;
+}
+
+
+/* Store the value for a key, replacing the current value if the key is
+ * already in the dict.
+ *
+ * The dict takes over the reference to value from the caller. For a new
+ * key a copy is stored.
+ */
+static void dict_store(DictObject *dict, Object *key, Object *value)
+{
+	DictEntry *entry;
+	Object *replaced;
+
+	if ((entry = insert(dict, key, hash_of(key), false)) == NULL) {
+		obj_decref(value);
+		return;
+	}
+
+	replaced = entry->value;
+	entry->value = value;
+
+	if (replaced)
+		obj_decref(replaced);
+}
+
+
+/* Replace the value for a key by the result of 'operation' on this value
+ * and 'value'.
+ *
+ * Just like for lists 'operation' can be one of the obj_..._tmp()
+ * functions, which then modifies a value only held by the dict in place.
+ *
+ * Note: The refcount of the result is increased by 1.
+ *
+ * return	new value or none-object in case of error
+ */
+static Object *dict_update(DictObject *dict, Object *key, Object *(*operation)(Object *, Object *), Object *value)
+{
+	DictEntry *entry;
+	Object *obj, *replaced;
+
+	if ((entry = find(dict, key)) == NULL) {
+		missing(key);
+		return obj_alloc(NONE_T);
+	}
+
+	obj = operation(entry->value, value);
+
+	replaced = entry->value;
+	entry->value = obj;
+	obj_decref(replaced);
+
+	obj_incref(obj);
+
+	return obj;
+}
+
+
+/* Check if a key is in a dict.
+ */
+static bool dict_contains(DictObject *dict, Object *key)
+{
+	return find(dict, key) != NULL;
+}
+
+
+/* Remove a key from a dict.
+ *
+ * return	value which belonged to the key, or none-object if the key was
+ *			not in the dict
+ */
+static Object *dict_remove(DictObject *dict, Object *key)
+{
+	DictEntry *entry;
+	Object *value;
+
+	if ((entry = find(dict, key)) == NULL) {
+		missing(key);
+		return obj_alloc(NONE_T);
+	}
+
+	obj_decref(entry->key);
+	value = entry->value;
+
+	entry->key = REMOVED;
+	entry->value = NULL;
+
+	dict->size--;
+
+	return value;  /* the reference of the dict is handed over to the caller */
+}
+
+
+/* Return a list with copies of all keys (which is true) or all values.
+ *
+ * return	new list-object
+ */
+static Object *collect(DictObject *dict, bool keys)
+{
+	ListObject *list = (ListObject *)obj_alloc(LIST_T);
+
+	for (int_t i = 0; dict->slot && i <= dict->mask; i++)
+		if (isUsed(&dict->slot[i]))
+			listtype.append(list, obj_copy(keys ? dict->slot[i].key : dict->slot[i].value));
+
+	return (Object *)list;
+}
+
+
+/* Execute a method on a dict.
+ *
+ * obj			dict-object for which method was called
+ * name			method name
+ * arguments	method arguments as array with pointers to objects
+ * return		object with method results or none-object in case of error
+ */
+static Object *dict_method(DictObject *obj, char *name, Array *arguments)
+{
+	Object *result;
+
+	if (strcmp("len", name) == 0) {
+		if (arguments->size != 0) {
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+			result = obj_alloc(NONE_T);
+		} else
+			result = dicttype.length(obj);
+	} else if (strcmp("keys", name) == 0 || strcmp("values", name) == 0) {
+		if (arguments->size != 0) {
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+			result = obj_alloc(NONE_T);
+		} else
+			result = collect(obj, name[0] == 'k');
+	} else if (strcmp("remove", name) == 0) {
+		if (arguments->size != 1) {
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+			result = obj_alloc(NONE_T);
+		} else
+			result = dicttype.remove(obj, arguments->element[0]);
+	} else {
+		raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
+		result = obj_alloc(NONE_T);
+	}
+
+	return result;
+}
+
+
+/* Check if two dicts contain the same keys with equal values.
+ */
+static bool dict_cmp(DictObject *op1, DictObject *op2)
+{
+	DictEntry *entry;
+	Object *obj;
+	bool equal;
+
+	if (op1->size != op2->size)
+		return false;
+
+	for (int_t i = 0; op1->slot && i <= op1->mask; i++)
+		if (isUsed(&op1->slot[i])) {
+			if ((entry = find(op2, op1->slot[i].key)) == NULL)
+				return false;
+			obj = obj_eql(op1->slot[i].value, entry->value);
+			equal = obj_as_bool(obj);
+			obj_decref(obj);
+			if (equal == false)
+				return false;
+		}
+
+	return true;
+}
+
+
+/* Check if content of two dicts is equal.
+ *
+ * return	integer-object with value 1 if equal or value 0 if not equal
+ */
+static Object *dict_eql(DictObject *op1, DictObject *op2)
+{
+	return obj_bool(dict_cmp(op1, op2));
+}
+
+
+/* Check if content of two dicts is not equal.
+ *
+ * return	integer-object with value 0 if equal or value 1 if not equal
+ */
+static Object *dict_neq(DictObject *op1, DictObject *op2)
+{
+	return obj_bool(!dict_cmp(op1, op2));
+}
+
+
+/* Start iterating over the keys of a dict.
+ */
+static void dict_begin(DictObject *dict, CursorObject *cursor)
+{
+	cursor->index = 0;
+	cursor->end = dict->slot ? dict->mask + 1 : 0;
+}
+
+
+/* Return a copy of the next key of a dict. Keys which are added while
+ * iterating are not necessarily visited.
+ *
+ * return	new object or NULL if there are no keys left
+ */
+static Object *dict_next(CursorObject *cursor)
+{
+	DictObject *dict = (DictObject *)cursor->sequence;
+	DictEntry *entry;
+
+	while (cursor->index < cursor->end && dict->slot && cursor->index <= dict->mask) {
+		entry = &dict->slot[cursor->index++];
+		if (isUsed(entry))
+			return obj_copy(entry->key);
+	}
+	return NULL;
+}
+
+
+/* Dict object API.
+ */
+DictType dicttype = {
+	.name = "dict",
+	.alloc = (Object *(*)())dict_alloc,
+	.free = (void (*)(Object *))dict_free,
+	.print = (void (*)(FILE *, Object *))dict_print,
+	.set = dict_set,
+	.vset = (void (*)(Object *, va_list))dict_vset,
+	.method = (Object *(*)(Object *, char *, Array *))dict_method,
+	.begin = (void (*)(Object *, struct cursor *))dict_begin,
+	.next = dict_next,
+
+	.length = dict_length,
+	.item = dict_item,
+	.store = dict_store,
+	.update = dict_update,
+	.contains = dict_contains,
+	.remove = dict_remove
+	};
+
+
+/* Create a new empty set-object.
+ *
+ * return	new set-object or NULL in case of error
+ */
+static SetObject *set_alloc(void)
+{
+	SetObject *obj;
+
+	if ((obj = dict_alloc()) != NULL) {
+		obj->typeobj = (TypeObject *)&settype;
+		obj->type = SET_T;
+	}
+	return obj;  /* returns NULL if alloc failed */
+}
+
+
+/* Print set content between curly brackets.
+ *
+ */
+static void set_print(FILE *fp, SetObject *set)
+{
+	int_t count = 0;
+
+	fprintf(fp, "{");
+
+	for (int_t i = 0; set->slot && i <= set->mask; i++)
+		if (isUsed(&set->slot[i])) {
+			obj_print(fp, set->slot[i].key);
+			if (++count < set->size)
+				fprintf(fp, ",");
+		}
+
+	fprintf(fp, "}");
+}
+
+
+/* Check if a key with a known hash value is in a dict or set.
+ */
+static bool has(DictObject *dict, Object *key, size_t hash)
+{
+	return dict->size != 0 && isUsed(lookup(dict, key, hash));
+}
+
+
+/* Add all items of 'source' to a set.
+ *
+ * The keys of a set or dict are added with their stored hash value. For
+ * a list the table is sized once for all items, so it does not grow
+ * while the items are added. Other sequences are read via a cursor.
+ */
+static void fill(SetObject *set, Object *source)
+{
+	DictObject *dict;
+	ListObject *list;
+	Object *cursor, *item;
+
+	switch (TYPE(source)) {
+		case SET_T:
+		case DICT_T:
+			dict = (DictObject *)source;
+			for (int_t i = 0; dict->slot && i <= dict->mask; i++)
+				if (isUsed(&dict->slot[i]))
+					insert(set, dict->slot[i].key, dict->slot[i].hash, true);
+			break;
+		case LIST_T:
+			list = (ListObject *)source;
+			if (set->slot == NULL && list->size != 0 && allocate(set, list->size) == false)
+				break;
+			for (int_t i = 0; i < list->size; i++)
+				insert(set, list->item[i], hash_of(list->item[i]), false);
+			break;
+		default:
+			if (TYPEOBJ(source)->begin == NULL) {
+				raise(ValueError, "cannot convert %s to set", TYPENAME(source));
+				break;
+			}
+			cursor = obj_iterate(source);
+			while ((item = obj_next(cursor)) != NULL) {
+				insert(set, item, hash_of(item), false);
+				obj_decref(item);
+			}
+			obj_decref(cursor);
+	}
+}
+
+
+/* Replace the content of set 'dest' by the items of 'src'.
+ *
+ * src		set, dict (its keys) or sequence
+ */
+static void set_set(SetObject *dest, Object *src)
+{
+	if ((Object *)dest == src)
+		return;
+
+	obj_incref(src);  /* src may be held by dest */
+
+	clear(dest);
+	fill(dest, src);
+
+	obj_decref(src);
+}
+
+
+static void set_vset(SetObject *obj, va_list argp)
+{
+	set_set(obj, va_arg(argp, Object *));
+}
+
+
+/* Add a copy of a key to a set, if it is not yet present.
+ */
+static void set_add(SetObject *set, Object *key)
+{
+	insert(set, key, hash_of(key), false);
+}
+
+
+/* Create a new set with the keys of 'set' which are (if 'keep' is true)
+ * or are not (if 'keep' is false) in 'other'.
+ *
+ * other	set, dict or sequence
+ * return	new set-object
+ */
+static Object *pick(SetObject *set, Object *other, bool keep)
+{
+	SetObject *result = (SetObject *)obj_alloc(SET_T);
+	DictObject *table;
+
+	if (TYPE(other) == SET_T || TYPE(other) == DICT_T) {
+		table = (DictObject *)other;
+		obj_incref(table);
+	} else
+		table = (DictObject *)obj_create(SET_T, other);
+
+	for (int_t i = 0; set->slot && i <= set->mask; i++)
+		if (isUsed(&set->slot[i]) && has(table, set->slot[i].key, set->slot[i].hash) == keep)
+			insert(result, set->slot[i].key, set->slot[i].hash, true);
+
+	obj_decref(table);
+
+	return (Object *)result;
+}
+
+
+/* Execute a method on a set.
+ *
+ * obj			set-object for which method was called
+ * name			method name
+ * arguments	method arguments as array with pointers to objects
+ * return		object with method results or none-object in case of error
+ */
+static Object *set_method(SetObject *obj, char *name, Array *arguments)
+{
+	Object *result;
+
+	if (strcmp("len", name) == 0) {
+		if (arguments->size != 0) {
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+			result = obj_alloc(NONE_T);
+		} else
+			result = settype.length(obj);
+	} else if (strcmp("add", name) == 0) {
+		if (arguments->size != 1)
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+		else
+			settype.add(obj, arguments->element[0]);
+		result = obj_alloc(NONE_T);
+	} else if (strcmp("remove", name) == 0) {
+		if (arguments->size != 1)
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+		else
+			dict_remove(obj, arguments->element[0]);
+		result = obj_alloc(NONE_T);
+	} else if (strcmp("union", name) == 0) {
+		if (arguments->size != 1) {
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+			result = obj_alloc(NONE_T);
+		} else {
+			result = obj_create(SET_T, obj);
+			fill((SetObject *)result, arguments->element[0]);
+		}
+	} else if (strcmp("intersection", name) == 0 || strcmp("difference", name) == 0) {
+		if (arguments->size != 1) {
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+			result = obj_alloc(NONE_T);
+		} else
+			result = pick(obj, arguments->element[0], name[0] == 'i');
+	} else {
+		raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
+		result = obj_alloc(NONE_T);
+	}
+
+	return result;
+}
+
+
+/* Check if two sets contain the same keys.
+ */
+static bool set_cmp(SetObject *op1, SetObject *op2)
+{
+	if (op1->size != op2->size)
+		return false;
+
+	for (int_t i = 0; op1->slot && i <= op1->mask; i++)
+		if (isUsed(&op1->slot[i]) && has(op2, op1->slot[i].key, op1->slot[i].hash) == false)
+			return false;
+
+	return true;
+}
+
+
+/* Check if content of two sets is equal.
+ *
+ * return	integer-object with value 1 if equal or value 0 if not equal
+ */
+static Object *set_eql(SetObject *op1, SetObject *op2)
+{
+	return obj_bool(set_cmp(op1, op2));
+}
+
+
+/* Check if content of two sets is not equal.
+ *
+ * return	integer-object with value 0 if equal or value 1 if not equal
+ */
+static Object *set_neq(SetObject *op1, SetObject *op2)
+{
+	return obj_bool(!set_cmp(op1, op2));
+}
+
+
+/* Set object API.
+ */
+SetType settype = {
+	.name = "set",
+	.alloc = (Object *(*)())set_alloc,
+	.free = (void (*)(Object *))dict_free,
+	.print = (void (*)(FILE *, Object *))set_print,
+	.set = set_set,
+	.vset = (void (*)(Object *, va_list))set_vset,
+	.method = (Object *(*)(Object *, char *, Array *))set_method,
+	.begin = (void (*)(Object *, struct cursor *))dict_begin,
+	.next = dict_next,
+
+	.length = dict_length,
+	.contains = dict_contains,
+	.add = set_add
+	};
+
+
+/* Register the kernels for the binary operators on dicts and sets (see
+ * object.h).
+ */
+void dict_register(void)
+{
+	obj_register(OBJ_EQL, DICT_T, DICT_T, (kernel_t)dict_eql);
+	obj_register(OBJ_NEQ, DICT_T, DICT_T, (kernel_t)dict_neq);
+	obj_register(OBJ_EQL, SET_T, SET_T, (kernel_t)set_eql);
+	obj_register(OBJ_NEQ, SET_T, SET_T, (kernel_t)set_neq);
+}
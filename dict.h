@@ -0,0 +1,57 @@
+/* dict.h
+ *
+ * A dict maps keys to values. The keys are numbers or strings. Key and
+ * value pairs are stored in a hash table with open addressing: a single
+ * array of slots, where a key which collides with another key is put
+ * in the next free slot along a probe sequence. As the hash value of
+ * the key is stored with the pair, the keys are only hashed once, also
+ * when the table grows.
+ *
+ * A set is a dict without values, the value of every slot is NULL. It
+ * uses the same hash table code.
+ */
+#ifndef _DICT_
+#define _DICT_
+
+#include "object.h"
+
+typedef struct {
+	Object *key;			/* NULL if the slot was never used, see dict.c for removed keys */
+	Object *value;
+	size_t hash;			/* hash value of key */
+} DictEntry;
+
+typedef struct dictobject {
+	OBJ_HEAD;
+	int_t size;				/* number of keys */
+	int_t fill;				/* number of slots in use, including those of removed keys */
+	int_t mask;				/* number of slots - 1, the number of slots is a power of 2 */
+	DictEntry *slot;		/* array with slots, NULL for an empty dict */
+} DictObject;
+
+typedef struct {
+	TYPE_HEAD;
+	Object *(*length)(DictObject *dict);
+	Object *(*item)(DictObject *dict, Object *key);
+	void (*store)(DictObject *dict, Object *key, Object *value);
+	Object *(*update)(DictObject *dict, Object *key, Object *(*operation)(Object *, Object *), Object *value);
+	bool (*contains)(DictObject *dict, Object *key);
+	Object *(*remove)(DictObject *dict, Object *key);
+} DictType;
+
+extern DictType dicttype;
+
+typedef DictObject SetObject;
+
+typedef struct {
+	TYPE_HEAD;
+	Object *(*length)(SetObject *set);
+	bool (*contains)(SetObject *set, Object *key);
+	void (*add)(SetObject *set, Object *key);
+} SetType;
+
+extern SetType settype;
+
+extern void dict_register(void);
+
+#endif
@@ -31,7 +31,8 @@ static struct {
 	{ OutOfMemoryError, "Out of memory", false },
 	{ ModNotAllowedError, "ModNotAllowedError", true },
 	{ DivisionByZeroError, "DivisionByZeroError: division by zero", false },
-	{ DesignError, "DesignError", true }
+	{ DesignError, "DesignError", true },
+	{ KeyError, "KeyError", true }
 };
 
 
@@ -20,6 +20,7 @@
 #define ModNotAllowedError 8	/* using mod on anything other then an integer */
 #define DivisionByZeroError 9	/* something / 0 */
 #define DesignError 10			/* error in the design of EXIN, my bad ;) */
+#define KeyError 11				/* key not found in dict */
 
 extern void raise(const int number, ...);
 
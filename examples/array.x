@@ -0,0 +1,20 @@
+# array.x
+#
+# An array stores its numbers in a single block of memory. Arithmetic
+# works on all elements at once.
+
+array a = range(1, 6)
+array b = [0.5, 1, 1.5, 2, 2.5]  # one float makes it a float array
+
+print a, b
+print a * 2 + 1
+print a + b
+print a.sum(), a.min(), a.max(), a.dot(b)
+
+a[0] = 10
+a[1] *= 2
+a += 1
+print a, a[1:3], a[-1]
+
+a.append(99)
+print a.len(), a
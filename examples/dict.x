@@ -0,0 +1,20 @@
+# dict.x
+#
+# Count how often every word occurs in a text.
+
+list words = ["the", "quick", "fox", "jumps", "over", "the", "lazy", "dog", "and", "the", "cat"]
+dict count
+
+for word in words
+    if word in count
+        count[word] += 1
+    else
+        count[word] = 1
+
+print count.len(), "different words"
+
+for word in sorted(count)  # the order of the keys is not defined, so sort them
+    print word, count[word]
+
+print "removed", count.remove("the"), "times the"
+print "the" in count
@@ -0,0 +1,22 @@
+# range.x
+#
+# A range produces its integers one at a time, so a loop over a long
+# range does not first create a list with all the integers.
+
+for i in range(0, 5)
+    print -raw i, " "
+print
+
+for i in range(10, 0, -3)  # count down
+    print -raw i, " "
+print
+
+int total
+for i in range(0, 1000000)
+    total += i
+print "sum of 0 .. 999999 =", total
+
+print 9 in range(0, 10, 3), 10 in range(0, 10, 3)  # no items are visited
+
+list l = range(0, 5)  # assigning a range to a list does create the list
+print l
@@ -0,0 +1,17 @@
+# set.x
+#
+# Find the letters two words have in common, and the ones they do not.
+
+set a = "abracadabra"
+set b = "cadillac"
+
+print a.len(), "different letters in abracadabra"
+print 'r' in a, 'r' in b
+
+print "both   ", sorted(a.intersection(b))
+print "either ", sorted(a.union(b))
+print "only a ", sorted(a.difference(b))
+
+a.add('z')
+a.remove('a')
+print sorted(a)
@@ -0,0 +1,18 @@
+# sort.x
+#
+# sort() puts a list in order, sorted() returns a new list and leaves
+# the original as it is.
+
+list l = [5, 3, 8, 1, 9, 2]
+print sorted(l), l
+
+l.sort()
+print l
+
+list names = ["pear", "apple", "fig", "apple pie", "Banana"]
+names.sort()
+print names  # uppercase comes before lowercase
+
+print sorted("exin")
+print sorted(range(5, 0, -1))
+print sorted([2.5, 1, 0.5, 2])  # integers and floats can be mixed
@@ -0,0 +1,31 @@
+# startup_benchmark.x
+#
+# Generate a module to measure the startup time of the interpreter.
+#
+# The generated module declares a chain of functions. Every function
+# contains several calls to its predecessor. When run only the last
+# function is called, and with argument 0 this executes no other calls.
+# So the time needed to run the generated module is dominated by parsing
+# and checking, which should grow linearly with the number of functions
+# and calls.
+#
+# Usage: exin startup_benchmark.x > module.x
+#        time exin module.x
+
+int functions = 2000  # number of functions to generate
+int calls = 40  # number of calls per function
+int i, j
+
+print -raw "def f0(n)\n    return n\n\n"
+
+i = 1
+while i < functions
+    print -raw "def f", i, "(n)\n    int r\n    if n > 0\n"
+    j = 0
+    while j < calls
+        print -raw "        r += f", i - 1, "(n - 1)\n"
+        j += 1
+    print -raw "    return r\n\n"
+    i += 1
+
+print -raw "print f", functions - 1, "(0)\n"
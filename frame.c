@@ -0,0 +1,185 @@
+/* frame.c
+ *
+ * Frame management.
+ *
+ * During execution the objects bound to variables are stored in frames.
+ * A frame is a contiguous array of slots, one for every variable in a
+ * scope level. A new frame is created when a function is called, and
+ * released again when the function returns.
+ *
+ * Variables are not searched by name. Instead check() resolves every
+ * variable to its scope depth and slot index (see Location in ast.h).
+ * Scoping is lexical: a function can access the variables of its
+ * enclosing functions and of the global level. To find the frames of the
+ * enclosing functions quickly the active frame for every depth is kept in
+ * array 'level' (a 'display'). When calling a function the frame which
+ * was active at the same depth is saved in the new frame, and restored
+ * when the function returns. This happens for recursive calls, or when
+ * a function calls another function at the same depth.
+ *
+ * Calls are strictly nested, so the frames are created and released in
+ * LIFO order. Instead of taking every frame from the heap they are cut
+ * from a frame stack: a chain of large chunks of memory. Creating a frame
+ * only moves the top of the current chunk, and releasing it moves the top
+ * back. Chunks which became empty are kept for the next deep call chain.
+ */
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "error.h"
+#include "frame.h"
+
+#define CHUNKSIZE	8192	/* default size of a chunk as number of pointers */
+
+/* Size of a frame with 'slots' slots as number of pointers.
+ */
+#define FRAMESIZE(slots)	((sizeof(Frame) + (slots) * sizeof(Object *) + sizeof(Object *) - 1) / sizeof(Object *))
+
+
+/* A chunk of memory from which frames are allocated.
+ */
+typedef struct chunk {
+	struct chunk *previous;	/* chunk below this one in the frame stack */
+	struct chunk *next;		/* empty chunk above this one, kept for reuse */
+	Object **top;			/* first free element */
+	Object **end;			/* first element beyond the chunk */
+	Object *base[];
+} Chunk;
+
+static Chunk *current = NULL;	/* chunk containing the top of the frame stack */
+
+
+/* Continue the frame stack in an empty chunk with room for at least 'size' pointers.
+ * The empty chunk above the current one is reused if it is large enough.
+ *
+ * size		number of pointers needed
+ */
+static void next_chunk(size_t size)
+{
+	Chunk *chunk = current ? current->next : NULL;
+
+	if (chunk && chunk->end - chunk->base < (ptrdiff_t)size) {
+		/* too small, release it and all chunks above it */
+		while (chunk) {
+			Chunk *next = chunk->next;
+			free(chunk);
+			chunk = next;
+		}
+	}
+
+	if (chunk == NULL) {
+		if (size < CHUNKSIZE)
+			size = CHUNKSIZE;
+
+		if ((chunk = malloc(sizeof(Chunk) + size * sizeof(Object *))) == NULL)
+			raise(OutOfMemoryError);
+
+		chunk->previous = current;
+		chunk->next = NULL;
+		chunk->end = chunk->base + size;
+
+		if (current)
+			current->next = chunk;
+	}
+
+	chunk->top = chunk->base;
+	current = chunk;
+}
+
+
+/* API: Create a new frame and make it the active frame at 'depth'.
+ *
+ * depth	scope depth of the new frame
+ * size		number of slots in the frame
+ */
+static void enter(int depth, int size)
+{
+	Frame *frame;
+	size_t framesize = FRAMESIZE(size);
+
+	if (depth >= display.capacity) {
+		int capacity = depth + 8;
+
+		if ((display.level = realloc(display.level, capacity * sizeof(Frame *))) == NULL)
+			raise(OutOfMemoryError);
+
+		for (int i = display.capacity; i < capacity; i++)
+			display.level[i] = NULL;
+
+		display.capacity = capacity;
+	}
+
+	if (current == NULL || current->end - current->top < (ptrdiff_t)framesize)
+		next_chunk(framesize);
+
+	frame = (Frame *)current->top;
+	current->top += framesize;
+
+	memset(frame->slot, 0, size * sizeof(Object *));
+
+	frame->size = size;
+	frame->previous = display.level[depth];
+
+	display.level[depth] = frame;
+}
+
+
+/* API: Release the active frame at 'depth' and reactivate the previous one.
+ *
+ * Also releases all objects bound to the variables in the frame. The frame
+ * must be the last one which was created.
+ */
+static void leave(int depth)
+{
+	Frame *frame = display.level[depth];
+
+	assert((Object **)frame + FRAMESIZE(frame->size) == current->top);
+
+	for (int i = 0; i < frame->size; i++)
+		if (frame->slot[i])
+			obj_decref(frame->slot[i]);
+
+	display.level[depth] = frame->previous;
+
+	current->top = (Object **)frame;
+
+	if (current->top == current->base && current->previous)
+		current = current->previous;
+}
+
+
+/* API: Bind an object to a variable. First release an existing binding (if any).
+ *
+ * depth	scope depth of the variable
+ * slot		index of the variable in the frame
+ * obj		object to bind to the variable
+ *
+ * Binding does *not* increment an objects reference counter. This must be
+ * done by the function supplying or using the object.
+ */
+static void bind(int depth, int slot, Object *obj)
+{
+	Object **variable = &display.level[depth]->slot[slot];
+
+	debug_printf(DEBUGALLOC, "\nbind  : %d:%d, %-p", depth, slot, (void *)obj);
+
+	if (*variable)
+		obj_decref(*variable);
+
+	*variable = obj;
+}
+
+
+/* The display API.
+ */
+Display display = {
+	.level = NULL,
+	.capacity = 0,
+
+	.enter = enter,
+	.leave = leave,
+	.bind = bind
+	};
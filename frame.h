@@ -0,0 +1,76 @@
+/* frame.h
+ *
+ * Data structures for the activation records (frames) which hold the values
+ * of the variables during execution.
+ */
+#ifndef _FRAME_
+#define _FRAME_
+
+#include "object.h"
+#include "number.h"
+
+
+/* The variables of a single scope level, so of one function call or of
+ * the global level. Which slot belongs to which variable is determined
+ * by check().
+ */
+typedef struct frame {
+	struct frame *previous;	/* frame which was active at the same depth before this one */
+	int size;				/* number of slots */
+	Object *slot[];			/* objects bound to the variables, NULL if unbound */
+} Frame;
+
+
+/* The active frame for every scope depth. Depth 0 is the global level,
+ * depth 1 a function declared at global level, depth 2 a function nested
+ * within a depth 1 function, etc.
+ */
+typedef struct display {
+	Frame **level;		/* level[depth] is the active frame at this depth */
+	int capacity;		/* number of elements in level */
+
+	void (*enter)(int depth, int size);
+	void (*leave)(int depth);
+	void (*bind)(int depth, int slot, Object *obj);
+} Display;
+
+extern Display display;
+
+
+/* Return the object bound to the variable at 'slot' in the active
+ * frame at 'depth', NULL if the variable has no value yet.
+ */
+static inline Object *frame_object(int depth, int slot)
+{
+	return display.level[depth]->slot[slot];
+}
+
+
+/* Bind integer 'value' to the variable at 'slot' in the active frame
+ * at 'depth'. If the variable holds an integer object which nobody else
+ * refers to then this object is reused, else a new one is bound.
+ */
+static inline void frame_bind_int(int depth, int slot, int_t value)
+{
+	Object *obj = display.level[depth]->slot[slot];
+
+	if (obj && isTemporary(obj) && TYPE(obj) == INT_T)
+		((IntObject *)obj)->ival = value;
+	else
+		display.bind(depth, slot, obj_create(INT_T, value));
+}
+
+
+/* Bind character 'value' to a variable, see frame_bind_int().
+ */
+static inline void frame_bind_char(int depth, int slot, char_t value)
+{
+	Object *obj = display.level[depth]->slot[slot];
+
+	if (obj && isTemporary(obj) && TYPE(obj) == CHAR_T)
+		((CharObject *)obj)->cval = value;
+	else
+		display.bind(depth, slot, obj_create(CHAR_T, value));
+}
+
+#endif
@@ -4,7 +4,9 @@
  *
  * These offer a simple way to add functions to the language. A built-in
  * function receives an array with all function arguments (if any) and a
- * stack where to place the function result. Decoding and checking the
+ * stack where to place the function result. The builtin must release the
+ * arguments. As the arguments may be located on the same stack it may
+ * only push its result after it is done with the arguments. Decoding and checking the
  * function arguments is done when the function is executed, and thus
  * is not part of the check() routine.
  *
@@ -14,6 +16,8 @@
 #include <string.h>
 
 #include "list.h"
+#include "str.h"
+#include "range.h"
 #include "error.h"
 #include "object.h"
 #include "function.h"
@@ -23,34 +27,44 @@
  *
  * Syntax: type(expression)
  */
-static void type(Array *arguments, Stack *s)
+static void type(Object *arguments[], Stack *s)
 {
-	Object *obj = arguments->element[0];
+	Object *obj = arguments[0];
 
-	Object *result = isListNode(obj) ? obj_type(obj_from_listnode(obj)) : obj_type(obj);
+	Object *result = obj_type(obj);
 
 	obj_decref(obj);
 
-	stack.push(s, result);
+	stack_push(s, result);
 }
 
 
 /* Built-in: return ASCII character (as string) representation of integer
+ *
+ * The string for a character is created on first use and is never
+ * released, just like the string of a literal. So chr() in a loop does
+ * not allocate memory.
  *
  * Syntax: chr(integer expression)
  */
-static void chr(Array *arguments, Stack *s)
+static void chr(Object *arguments[], Stack *s)
 {
-	char buffer[MAXNUMBER];
+	static Object *string[UCHAR_MAX + 1];
+
+	Object *obj = arguments[0];
 
-	Object *obj = arguments->element[0];
+	char c = obj_as_char(obj);
+	Object **result = &string[(unsigned char)c];
 
-	snprintf(buffer, sizeof(buffer), "%c", obj_as_char(obj));
-	Object *result = obj_create(STR_T, buffer);
+	if (*result == NULL) {
+		*result = (Object *)strtype.create(&c, 1);
+		(*result)->refcount = IMMORTAL;
+	}
 
+	obj_incref(*result);
 	obj_decref(obj);
 
-	stack.push(s, result);
+	stack_push(s, *result);
 }
 
 
@@ -58,38 +72,76 @@ static void chr(Array *arguments, Stack *s)
  *
  * Syntax: ord(string expression)
  */
-static void ord(Array *arguments, Stack *s)
+static void ord(Object *arguments[], Stack *s)
 {
-	Object *obj = arguments->element[0];
+	Object *obj = arguments[0];
 
 	if (TYPE(obj) != STR_T)
 		raise(TypeError, "expected string but found %s", TYPENAME(obj));
 
-	Object *result = obj_create(INT_T, (int_t)obj_as_char(obj));
+	Object *result = obj_int((int_t)obj_as_char(obj));
 
 	obj_decref(obj);
 
-	stack.push(s, result);
+	stack_push(s, result);
+}
+
+
+/* Built-in: return a lazy sequence of integers from start up to (but
+ * not including) stop. Step is optional and defaults to 1.
+ *
+ * Syntax: range(integer expression, integer expression[, integer expression])
+ */
+static void range(Object *arguments[], Stack *s)
+{
+	Object *result = obj_create(RANGE_T, obj_as_int(arguments[0]), obj_as_int(arguments[1]), obj_as_int(arguments[2]));
+
+	for (int i = 0; i < 3; i++)
+		obj_decref(arguments[i]);
+
+	stack_push(s, result);
+}
+
+
+/* Built-in: return a new list with the items of a sequence in ascending order
+ *
+ * Syntax: sorted(sequence expression)
+ */
+static void sorted(Object *arguments[], Stack *s)
+{
+	Object *obj = arguments[0];
+
+	Object *result = obj_create(LIST_T, obj);
+
+	listtype.sort((ListObject *)result);
+
+	obj_decref(obj);
+
+	stack_push(s, result);
 }
 
 
 /* Table containing all built-in function names, the expected
- * number of arguments (will be passed as an array of objects)
+ * number of arguments (will be passed as an array of objects),
+ * the default value of the last argument if it may be omitted
  * and the function addresses.
  *
- * The function signature is 'void function(Array *, Stack *)' where
- * Array contains the argument objects and the stack is where
+ * The function signature is 'void function(Object *[], Stack *)' where
+ * the array contains the argument objects and the stack is where
  * the return value must be pushed.
  *
  */
 static struct {
 	char *functionname;
 	size_t argc;
-	void (*functionaddr)(Array *, Stack *);
+	char *optional;  /* integer literal, NULL if all arguments are mandatory */
+	builtin_t functionaddr;
 } builtinTable[] = {  /* Note: function names *must* be sorted alphabetically */
-	{"chr", 1, chr},
-	{"ord", 1, ord},
-	{"type", 1, type}
+	{"chr", 1, NULL, chr},
+	{"ord", 1, NULL, ord},
+	{"range", 3, "1", range},
+	{"sorted", 1, NULL, sorted},
+	{"type", 1, NULL, type}
 };
 
 
@@ -124,21 +176,20 @@ static int search_builtin(const char *functionname)
 }
 
 
-/* Execute a built-in function.
+/* Return the address of a built-in function.
+ *
+ * check() resolves every call to a built-in function once, so no
+ * names need to be searched when the call is executed.
  *
  * functionname	name of built-in function
- * arguments	array with function arguments (Object *)
- * s			stack where to place results
+ * return		address of the function
  */
-void visit_builtin(const char *functionname, Array *arguments, Stack *s)
+builtin_t builtin_address(const char *functionname)
 {
 	assert(functionname != NULL);
 	assert(is_builtin(functionname) == true);
 
-	int index = search_builtin(functionname);
-
-	if (index >= 0)
-		builtinTable[index].functionaddr(arguments, s);
+	return builtinTable[search_builtin(functionname)].functionaddr;
 }
 
 
@@ -158,7 +209,7 @@ bool is_builtin(const char *functionname)
 /* Return the number of arguments a built-in function expects.
  *
  * functionname	name of built-in function
- * return		true if functionname was a built-in function else false
+ * return		number of arguments, including an optional last one
  */
 size_t builtin_argc(const char *functionname)
 {
@@ -167,3 +218,20 @@ size_t builtin_argc(const char *functionname)
 
 	return builtinTable[search_builtin(functionname)].argc;
 }
+
+
+/* Return the default value for the last argument of a built-in function.
+ *
+ * check() adds this value as an integer literal to a call which omits
+ * the last argument, so the builtin always receives argc arguments.
+ *
+ * functionname	name of built-in function
+ * return		integer literal or NULL if the last argument is mandatory
+ */
+char *builtin_optional(const char *functionname)
+{
+	assert(functionname != NULL);
+	assert(is_builtin(functionname) == true);
+
+	return builtinTable[search_builtin(functionname)].optional;
+}
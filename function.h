@@ -5,11 +5,16 @@
 #ifndef _FUNCTION_
 #define _FUNCTION_
 
-#include "array.h"
+#include "object.h"
 #include "stack.h"
 
+/* Signature of a built-in function.
+ */
+typedef void (*builtin_t)(Object *arguments[], Stack *s);
+
 bool is_builtin(const char *functionname);
 size_t builtin_argc(const char *functionname);
-void visit_builtin(const char *functionname, Array *arguments, Stack *s);
+char *builtin_optional(const char *functionname);
+builtin_t builtin_address(const char *functionname);
 
 #endif
@@ -22,6 +22,17 @@
  * 'local' provide quick access to respectively the highest and lowest
  * levels in the scope hierarchy.
  *
+ * To find a name quickly every level also has a hash table. Identifiers
+ * whose names hash to the same bucket are linked via 'chain'. When the
+ * number of identifiers exceeds the number of buckets the table is doubled,
+ * so a search takes constant time even for a module with thousands of
+ * global functions.
+ *
+ * Identifiers are only used by check(). Here every variable gets a slot
+ * index within its scope level. During execution the values of the
+ * variables are stored in these slots (see frame.c), so no names need
+ * to be searched then.
+ *
  *	Copyright (c) 1994 K.W.E. de Lange
  */
 #include <stdlib.h>
@@ -29,6 +40,7 @@
 
 #include "identifier.h"
 #include "error.h"
+#include "frame.h"
 
 
 static Scope top = SCOPE_INIT;	/* head of global identifier list */
@@ -36,6 +48,46 @@ static Scope top = SCOPE_INIT;	/* head of global identifier list */
 static Scope *global = &top;	/* initially global ... */
 static Scope *local = &top;		/* ... and local scope are the same */
 
+#define MINBUCKETS	8			/* initial size of the hash table of a scope level */
+
+
+/* Calculate the hash value for an identifier name (FNV-1a).
+ */
+static size_t hash(const char *name)
+{
+	size_t h = 2166136261u;
+
+	while (*name)
+		h = (h ^ (unsigned char)*name++) * 16777619u;
+
+	return h;
+}
+
+
+/* Resize the hash table of a scope level and redistribute its identifiers.
+ *
+ * level	scope level
+ * buckets	new number of buckets, must be a power of 2
+ */
+static void rehash(Scope *level, size_t buckets)
+{
+	Identifier **bucket;
+	Identifier *id;
+
+	if ((bucket = calloc(buckets, sizeof(Identifier *))) == NULL)
+		raise(OutOfMemoryError);
+
+	for (id = level->first; id; id = id->next) {
+		size_t b = hash(id->name) & (buckets - 1);
+		id->chain = bucket[b];
+		bucket[b] = id;
+	}
+
+	free(level->bucket);
+	level->bucket = bucket;
+	level->buckets = buckets;
+}
+
 
 /* Search an identifier in a specific scope list.
  *
@@ -47,7 +99,10 @@ static Identifier *searchIdentifierInScope(const Scope *level, const char *name)
 {
 	Identifier *id;
 
-	for (id = level->first; id; id = id->next)
+	if (level->bucket == NULL)
+		return NULL;
+
+	for (id = level->bucket[hash(name) & (level->buckets - 1)]; id; id = id->chain)
 		if (strcmp(name, id->name) == 0)
 			break;
 
@@ -103,9 +158,18 @@ static Identifier *addIdentifier(identifiertype_t type, Scope *level, const char
 
 			id->type = type;
 			id->node = NULL;
-			id->object = NULL;
+			id->depth = level->depth;
+			id->slot = type == VARIABLE ? level->slots++ : -1;
 			id->next = level->first;
 			level->first = id;
+
+			if (++level->count > level->buckets)
+				rehash(level, level->buckets ? level->buckets * 2 : MINBUCKETS);
+			else {
+				size_t b = hash(name) & (level->buckets - 1);
+				id->chain = level->bucket[b];
+				level->bucket[b] = id;
+			}
 		}
 	}
 	return id;
@@ -123,49 +187,28 @@ static Identifier *add(identifiertype_t type ,const char *name)
 }
 
 
-/* API: Unbind an object and an identifier.
+/* API: Unbind a function declaration and an identifier.
  *
  * id		identifier to unbind
  *
- * Unbinding means there is one less reference to the object so
- * the objects reference counter is decremented. For identifiers
- * which point to functions only the pointer to the function
- * is removed.
+ * Variables have no binding here, their objects are stored in a frame.
  */
 static void unbind(Identifier *id)
 {
-	debug_printf(DEBUGALLOC, "\nunbind: %s%s, %-p", id->name, id->type == FUNCTION ? "()" : "", \
-							 id->type == FUNCTION ? (void *)0 : (void *)id->object);
-
-	if (id->type == VARIABLE) {
-		if (id->object) {
-			obj_decref(id->object);
-			id->object = NULL;
-		}
-	} else if (id->type == FUNCTION)
+	if (id->type == FUNCTION)
 		id->node = NULL;
 }
 
 
-/* API: Bind an object to an identifier. First remove an existing binding (if any).
- *
- * id		identifier to bind object to
- * obj		object to bind to identifier
+/* API: Bind a function declaration to an identifier.
  *
- * Binding does *not* increment an objects reference counter. This must be
- * done by the function supplying or using the object.
+ * id		identifier to bind node to
+ * node		function declaration node
  */
-static void bind(Identifier *id, void *obj)
+static void bind(Identifier *id, void *node)
 {
-	debug_printf(DEBUGALLOC, "\nbind  : %s%s, %-p", id->name, id->type == FUNCTION ? "()" : "" , \
-							 id->type == FUNCTION ? (void *)0 : (void *)obj);
-
-	if (id->type == VARIABLE) {
-		if (id->object)
-			unbind(id);
-		id->object = obj;
-	} else if (id->type == FUNCTION)
-		id->node = obj;
+	if (id->type == FUNCTION)
+		id->node = node;
 }
 
 
@@ -201,7 +244,12 @@ static void appendScopeLevel(bool nested)
 
 		level->parent = local;
 		level->first = NULL;
+		level->bucket = NULL;
+		level->buckets = 0;
+		level->count = 0;
 		level->nested = nested;
+		level->depth = local->depth + 1;
+		level->slots = 0;
 
 		local = level;
 	}
@@ -224,11 +272,34 @@ static void removeScopeLevel(void)
 		removeIdentifier(id);
 	}
 
+	free(level->bucket);
+
 	if (local != global) {
 		local = level->parent;
 		free(level);
-	} else
+	} else {
 		global->first = NULL;
+		global->bucket = NULL;
+		global->buckets = 0;
+		global->count = 0;
+		global->slots = 0;
+	}
+}
+
+
+/* API: Return the depth of the lowest level in the scope hierarchy.
+ */
+static int localDepth(void)
+{
+	return local->depth;
+}
+
+
+/* API: Return the number of variables in the lowest level in the scope hierarchy.
+ */
+static int localSlots(void)
+{
+	return local->slots;
 }
 
 
@@ -250,8 +321,9 @@ void dump_identifiers_to_file(FILE *fp)
 	for (level = local; level; level = level->parent, n--) {
 		for (id = level->first; id; id = id->next) {
 			fprintf(fp, "%d;%s;%s;", n, id->name, identifiertypeName(id->type));
-			if (id->object != NULL)
-				fprintf(fp, "%-p", (void *)id->object);
+			if (id->type == VARIABLE && id->depth < display.capacity && display.level[id->depth] && \
+				id->slot < display.level[id->depth]->size && frame_object(id->depth, id->slot) != NULL)
+				fprintf(fp, "%-p", (void *)frame_object(id->depth, id->slot));
 			fprintf(fp, "\n");
 		}
 	}
@@ -276,7 +348,8 @@ void dump_identifiers(void)
 Identifier identifier = {
 	.name = NULL,
 	.next = NULL,
-	.object = NULL,
+	.chain = NULL,
+	.node = NULL,
 
 	.add = add,
 	.search = search,
@@ -290,7 +363,12 @@ Identifier identifier = {
 Scope scope = {
 	.parent = NULL,
 	.first = NULL,
+	.bucket = NULL,
+	.buckets = 0,
+	.count = 0,
 
 	.append_level = appendScopeLevel,
-	.remove_level = removeScopeLevel
+	.remove_level = removeScopeLevel,
+	.local_depth = localDepth,
+	.local_slots = localSlots
 	};
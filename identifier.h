@@ -31,9 +31,11 @@ typedef struct identifier {
 	identifiertype_t type;
 	char *name;					/* points to a private copy of identifier name */
 	struct identifier *next;	/* NULL for last identifier in list */
+	struct identifier *chain;	/* next identifier in the same hash bucket */
 
-	struct object *object;
-	struct node *node;
+	int depth;					/* scope depth where the identifier was declared */
+	int slot;					/* index in the frame for variables, -1 for functions */
+	struct node *node;			/* function declaration for functions */
 
 	struct identifier *(*add)(const identifiertype_t type, const char *name);
 	struct identifier *(*search)(const char *name);
@@ -46,17 +48,29 @@ extern Identifier identifier;
 typedef struct scope {
 	struct scope *parent;
 	Identifier *first;
+	Identifier **bucket;		/* hash table for searching identifiers by name */
+	size_t buckets;				/* number of buckets, a power of 2 */
+	size_t count;				/* number of identifiers at this level */
 	bool nested;
+	int depth;					/* 0 for the global level */
+	int slots;					/* number of variables at this level */
 
 	void (*append_level)(bool nested);
 	void (*remove_level)(void);
+	int (*local_depth)(void);
+	int (*local_slots)(void);
 } Scope;
 
 extern Scope scope;
 
 #define SCOPE_INIT { .parent = NULL, \
                      .first = NULL, \
-					 .nested = false }
+                     .bucket = NULL, \
+                     .buckets = 0, \
+                     .count = 0, \
+					 .nested = false, \
+					 .depth = 0, \
+					 .slots = 0 }
 
 
 #ifdef DEBUG
@@ -4,9 +4,22 @@
  *
  * See list.h for an explanation on the data structures for lists.
  *
+ * Copying a list does not copy its objects. Instead the copy shares the
+ * array, and the reference count in the header of the array is incremented.
+ * Every function which modifies a list first calls unshare(). This gives
+ * the list a private array, which refers to the same objects as the shared
+ * array. So copying a list costs O(1), and the O(n) copy is only made when
+ * it is really needed.
+ * Objects in a list are never modified in place if they are referred to
+ * from elsewhere (their refcount is larger than 1). Nested lists, dicts
+ * and sets however can be modified in place, so an array which contains
+ * these is never shared. Such a list is copied including new objects
+ * (= deep copy).
+ *
  * 2016 K.W.E. de Lange
  */
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -14,13 +27,16 @@
 #include "error.h"
 #include "none.h"
 #include "list.h"
+#include "number.h"
+#include "str.h"
+#include "cursor.h"
+#include "pool.h"
 
 
-/* Minimal set of forward declarations.
- *
- */
-static int_t length(ListObject *obj);
+#define LISTINCREMENT	8	/* minimal number of elements to add when the list needs to grow */
+#define SORTRUN			32	/* length of the runs which are sorted by insertion before merging */
 
+#define HEADER(list)	((ListArray *)((char *)(list)->item - offsetof(ListArray, element)))
 
 
 /* Create a new empty list-object.
@@ -36,26 +52,117 @@ static ListObject *list_alloc(void)
 		obj->type = LIST_T;
 		obj->refcount = 0;
 
-		obj->head = NULL;
-		obj->tail = NULL;
+		obj->size = 0;
+		obj->capacity = 0;
+		obj->item = NULL;
 	}
 	return obj;  /* returns NULL if alloc failed */
 }
 
 
-/* Free a list-object, including all listnodes. Remove the
- * reference from the listnodes to the objects they hold.
+/* Give a list a private array if it shares its array with other lists.
  *
+ * return	true if successful, false if out of memory
  */
-static void list_free(ListObject *obj)
+static bool unshare(ListObject *list)
+{
+	ListArray *array;
+
+	if (list->item == NULL || HEADER(list)->refcount == 1)
+		return true;
+
+	if ((array = malloc(sizeof(ListArray) + list->capacity * sizeof(Object *))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	array->refcount = 1;
+	array->lists = HEADER(list)->lists;
+
+	for (int_t i = 0; i < list->size; i++) {
+		array->element[i] = list->item[i];
+		obj_incref(array->element[i]);
+	}
+
+	HEADER(list)->refcount--;
+
+	list->item = array->element;
+
+	return true;
+}
+
+
+/* Make sure a list can hold at least 'size' objects, and that it can be
+ * modified because its array is not shared.
+ *
+ * The capacity is at least doubled so appending n objects costs only
+ * O(log n) reallocations.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool reserve(ListObject *list, int_t size)
+{
+	ListArray *array;
+	int_t capacity;
+
+	if (unshare(list) == false)
+		return false;
+
+	if (size <= list->capacity)
+		return true;
+
+	capacity = list->capacity * 2;
+
+	if (capacity < size)
+		capacity = size < LISTINCREMENT ? LISTINCREMENT : size;
+
+	if ((array = realloc(list->item ? HEADER(list) : NULL, sizeof(ListArray) + capacity * sizeof(Object *))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	if (list->item == NULL) {
+		array->refcount = 1;
+		array->lists = 0;
+	}
+
+	list->item = array->element;
+	list->capacity = capacity;
+
+	return true;
+}
+
+
+/* Release all objects in a list. A shared array is left to the other lists.
+ */
+static void clear(ListObject *list)
 {
-	Object *item;
+	if (list->item && HEADER(list)->refcount > 1) {
+		HEADER(list)->refcount--;
+		list->item = NULL;
+		list->capacity = 0;
+	} else {
+		for (int_t i = 0; i < list->size; i++)
+			obj_decref(list->item[i]);
 
-	while (length(obj) > 0) {
-		item = listtype.remove(obj, 0);
-		obj_decref(item);
+		if (list->item)
+			HEADER(list)->lists = 0;
 	}
 
+	list->size = 0;
+}
+
+
+/* Free a list-object, and release the objects it holds.
+ *
+ */
+static void list_free(ListObject *obj)
+{
+	clear(obj);
+
+	if (obj->item)
+		free(HEADER(obj));
+
 	*obj = (const ListObject) { 0 };  /* clear the object struct, facilitates debugging */
 
 	free(obj);
@@ -69,9 +176,9 @@ static void list_print(FILE *fp, ListObject *obj)
 {
 	printf("[");
 
-	for (ListNode *listnode = obj->head; listnode; listnode = listnode->next) {
-		obj_print(fp, listnode->obj);
-		if (listnode->next)
+	for (int_t i = 0; i < obj->size; i++) {
+		obj_print(fp, obj->item[i]);
+		if (i < obj->size - 1)
 			fprintf(fp, ",");
 	}
 	fprintf(fp, "]");
@@ -80,29 +187,79 @@ static void list_print(FILE *fp, ListObject *obj)
 
 /* Copy the content of list 'src' to list 'dest'.
  *
- * List 'dest' will be emptied, and on return will
- * contain new objects (= deep copy).
+ * List 'dest' will be emptied, and on return will share the array
+ * of 'src'. Only if 'src' contains lists, dicts or sets 'dest' will contain new
+ * objects (= deep copy).
  *
  * dest		destination list
  * src		source list
  */
-static void list_set(ListObject *dest, ListObject *src)
+static void copy(ListObject *dest, ListObject *src)
 {
-	Object *item;
+	if (dest == src || (dest->item && dest->item == src->item))
+		return;
+
+	if (src->item && HEADER(src)->lists == 0) {
+		HEADER(src)->refcount++;  /* before clear() as src may be held by dest */
 
-	while (length(dest) > 0) {
-		item = listtype.remove(dest, 0);
-		obj_decref(item);
+		clear(dest);
+
+		if (dest->item)
+			free(HEADER(dest));
+
+		dest->item = src->item;
+		dest->size = src->size;
+		dest->capacity = src->capacity;
+		return;
 	}
 
-	for (ListNode *listnode = src->head; listnode; listnode = listnode->next)
-		listtype.append(dest, obj_copy(listnode->obj));
+	clear(dest);
+
+	if (reserve(dest, src->size) == false)
+		return;
+
+	for (int_t i = 0; i < src->size; i++)
+		listtype.append(dest, obj_copy(src->item[i]));
+}
+
+
+/* Replace the content of list 'dest' by the items of 'src'.
+ *
+ * A list is copied by copy(), other sequences - like a string, range,
+ * dict (its keys) or set - are read via a cursor.
+ *
+ * src		list or sequence
+ */
+static void list_set(ListObject *dest, Object *src)
+{
+	Object *cursor, *item;
+
+	if (isList(src)) {
+		copy(dest, (ListObject *)src);
+		return;
+	}
+
+	if (TYPEOBJ(src)->begin == NULL) {
+		raise(ValueError, "cannot convert %s to list", TYPENAME(src));
+		return;
+	}
+
+	obj_incref(src);  /* src may be held by dest */
+
+	clear(dest);
+
+	cursor = obj_iterate(src);
+	while ((item = obj_next(cursor)) != NULL)
+		listtype.append(dest, item);
+	obj_decref(cursor);
+
+	obj_decref(src);
 }
 
 
 static void list_vset(ListObject *obj, va_list argp)
 {
-	list_set(obj, va_arg(argp, ListObject *));
+	list_set(obj, va_arg(argp, Object *));
 }
 
 
@@ -151,6 +308,12 @@ static Object *list_method(ListObject *obj, char *name, Array *arguments)
 
 			result = listtype.remove(obj, obj_as_int(index));
 		}
+	} else if (strcmp("sort", name) == 0) {
+		if (arguments->size != 0)
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+		else
+			listtype.sort(obj);
+		result = obj_alloc(NONE_T);
 	} else {
 		raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
 		result = obj_alloc(NONE_T);
@@ -160,24 +323,7 @@ static Object *list_method(ListObject *obj, char *name, Array *arguments)
 }
 
 
-/* Count the number of listnodes in a list.
- *
- * obj		listobject for which to count listnodes
- * return	listnode count
- */
-static int_t length(ListObject *obj)
-{
-	ListNode *listnode;
-	int_t i;
-
-	for (i = 0, listnode = obj->head; listnode; i++, listnode = listnode->next)
-		;
-
-	return i;
-}
-
-
-/* Return listnode count as an integer-object.
+/* Return object count as an integer-object.
  *
  * return	integer-object with count or none-object in case of error
  */
@@ -185,7 +331,7 @@ static Object *list_length(ListObject *obj)
 {
 	Object *len;
 
-	if ((len = obj_create(INT_T, length(obj))) == NULL)
+	if ((len = obj_int(obj->size)) == NULL)
 		len = obj_alloc(NONE_T);
 
 	return len;
@@ -199,23 +345,18 @@ static Object *list_length(ListObject *obj)
 static Object *list_concat(ListObject *op1, ListObject *op2)
 {
 	ListObject *list;
-	ListNode *item;
 	int_t i;
 
 	if ((list = (ListObject *)obj_alloc(LIST_T)) == NULL)
 		return obj_alloc(NONE_T);
 
-	for (i = 0; i < length(op1); i++) {
-		item = listtype.item(op1, i);
-		listtype.append(list, obj_copy(item->obj));
-		obj_decref(item);
-	}
+	reserve(list, op1->size + op2->size);
 
-	for (i = 0; i < length(op2); i++) {
-		item = listtype.item(op2, i);
-		listtype.append(list, obj_copy(item->obj));
-		obj_decref(item);
-	}
+	for (i = 0; i < op1->size; i++)
+		listtype.append(list, obj_copy(op1->item[i]));
+
+	for (i = 0; i < op2->size; i++)
+		listtype.append(list, obj_copy(op2->item[i]));
 
 	return (Object *)list;
 }
@@ -232,8 +373,7 @@ static Object *list_concat(ListObject *op1, ListObject *op2)
  */
 static Object *list_repeat(Object *op1, Object *op2)
 {
-	ListObject *list;
-	ListNode *item;
+	ListObject *list, *l;
 	int_t i, times;
 
 	Object *s = TYPE(op1) == LIST_T ? op1 : op2;
@@ -247,17 +387,59 @@ static Object *list_repeat(Object *op1, Object *op2)
 	if ((list = (ListObject *)obj_alloc(LIST_T)) == NULL)
 		return obj_alloc(NONE_T);
 
+	l = (ListObject *)s;
+
+	reserve(list, times * l->size);
+
 	while (times--)
-		for (i = 0; i < length((ListObject *)s); i++) {
-			item = listtype.item((ListObject *)s, i);
-			listtype.append(list, obj_copy(item->obj));
-			obj_decref(item);
-		}
+		for (i = 0; i < l->size; i++)
+			listtype.append(list, obj_copy(l->item[i]));
 
 	return (Object *)list;
 }
 
 
+/* Append copies of the elements of list op2 to list op1 (op1 += op2).
+ *
+ * As the array of a list at least doubles when it grows, appending
+ * takes amortized constant time per element.
+ */
+static void list_iconcat(ListObject *op1, ListObject *op2)
+{
+	int_t size = op2->size;  /* op2 may be op1 itself */
+
+	if (reserve(op1, op1->size + size) == false)
+		return;
+
+	for (int_t i = 0; i < size; i++)
+		listtype.append(op1, obj_copy(op2->item[i]));
+}
+
+
+/* Repeat the content of list op1 n times (op1 *= n).
+ *
+ * Operand n is guaranteed to be number-object. If it is negative it will
+ * be silently adjusted to 0.
+ */
+static void list_irepeat(ListObject *op1, Object *n)
+{
+	int_t size = op1->size;
+	int_t times = obj_as_int(n);
+
+	if (times <= 0) {
+		clear(op1);
+		return;
+	}
+
+	if (reserve(op1, size * times) == false)
+		return;
+
+	while (--times)
+		for (int_t i = 0; i < size; i++)
+			listtype.append(op1, obj_copy(op1->item[i]));
+}
+
+
 /* Compare the content of two lists by index (math: tuple).
  *
  * return	true of content is equal else false
@@ -267,20 +449,15 @@ static bool list_cmp(ListObject *op1, ListObject *op2)
 	bool equal;
 	Object *obj;
 	int_t i, l1;
-	ListNode *item1, *item2;
 
-	l1 = length(op1);
+	l1 = op1->size;
 
-	if (l1 != length(op2))
+	if (l1 != op2->size)
 		return false;  /* the lists should at least be of equal length */
 
 	for (equal = true, i = 0; i < l1; i++) {
-		item1 = listtype.item(op1, i);
-		item2 = listtype.item(op2, i);
-		obj = obj_eql((Object *)item1, (Object *)item2);
+		obj = obj_eql(op1->item[i], op2->item[i]);
 		equal = obj_as_bool(obj);
-		obj_decref(item1);
-		obj_decref(item2);
 		obj_decref(obj);
 		if (equal == false)
 			break;  /* stop compare on first mismatch */
@@ -298,7 +475,7 @@ static Object *list_eql(ListObject *op1, ListObject *op2)
 {
 	Object *result;
 
-	if ((result = obj_create(INT_T, list_cmp(op1, op2))) == NULL)
+	if ((result = obj_bool(list_cmp(op1, op2))) == NULL)
 		result = obj_alloc(NONE_T);
 
 	return result;
@@ -314,45 +491,115 @@ static Object *list_neq(ListObject *op1, ListObject *op2)
 {
 	Object *result;
 
-	if ((result = obj_create(INT_T, !list_cmp(op1, op2))) == NULL)
+	if ((result = obj_bool(!list_cmp(op1, op2))) == NULL)
 		result = obj_alloc(NONE_T);
 
 	return result;
 }
 
 
-/* Retrieve a listnode from a list by its index.
+/* Retrieve an object from a list by its index.
  *
- * Note: The refcount of the listnode is increased by 1.
+ * Note: The refcount of the object is increased by 1.
  *
  * list		list to retrieve the object from
  * index	index number of object, negative numbers count from the end
- * return	retrieved listnode-object or none-object in case of error
+ * return	retrieved object or none-object in case of error
  */
-static ListNode *list_item(ListObject *list, int_t index)
+static Object *list_item(ListObject *list, int_t index)
 {
-	ListNode *listnode;
-	int_t len, i;
+	Object *obj;
 
-	len = length(list);
+	if (index < 0)
+		index += list->size;
+
+	if (index < 0 || index >= list->size) {
+		raise(IndexError);
+		return obj_alloc(NONE_T);
+	}
+
+	obj = list->item[index];
+
+	obj_incref(obj);
+
+	return obj;
+}
+
+
+/* Replace the object with index number 'index' by 'obj'.
+ *
+ * The list takes over the reference to obj from the caller. The
+ * replaced object is released, obj may be the replaced object itself.
+ *
+ * list		list to store the object in
+ * index	index number of object, negative numbers count from the end
+ * obj		object to store
+ */
+static void list_store(ListObject *list, int_t index, Object *obj)
+{
+	Object *replaced;
 
 	if (index < 0)
-		index += len;
+		index += list->size;
 
-	if (index < 0 || index >= len) {
+	if (index < 0 || index >= list->size) {
 		raise(IndexError);
-		return (ListNode *)obj_alloc(NONE_T);
+		obj_decref(obj);
+		return;
 	}
 
-	for (i = 0, listnode = list->head; listnode; i++, listnode = listnode->next) {
-		if (i == index) {
-			break;
-		}
+	if (unshare(list) == false) {
+		obj_decref(obj);
+		return;
+	}
+
+	replaced = list->item[index];
+
+	HEADER(list)->lists += isContainer(obj) - isContainer(replaced);
+
+	list->item[index] = obj;
+
+	obj_decref(replaced);
+}
+
+
+/* Replace the object with index number 'index' by the result of
+ * 'operation' on this object and 'value'.
+ *
+ * The list is the only holder of its objects after unshare(), unless
+ * they are referred to from elsewhere. So 'operation' can be one of the
+ * obj_..._tmp() functions, which then modifies the object in place.
+ *
+ * Note: The refcount of the result is increased by 1.
+ *
+ * list			list which holds the object
+ * index		index number of object, negative numbers count from the end
+ * operation	function which calculates the new object
+ * value		right operand of operation
+ * return		new object or none-object in case of error
+ */
+static Object *list_update(ListObject *list, int_t index, Object *(*operation)(Object *, Object *), Object *value)
+{
+	Object *obj;
+
+	if (index < 0)
+		index += list->size;
+
+	if (index < 0 || index >= list->size) {
+		raise(IndexError);
+		return obj_alloc(NONE_T);
 	}
 
-	obj_incref(listnode);
+	if (unshare(list) == false)
+		return obj_alloc(NONE_T);
+
+	obj = operation(list->item[index], value);
+
+	list_store(list, index, obj);
 
-	return listnode;
+	obj_incref(obj);
+
+	return obj;
 }
 
 
@@ -369,10 +616,9 @@ static ListNode *list_item(ListObject *list, int_t index)
 static ListObject *list_slice(ListObject *list, int_t start, int_t end)
 {
 	ListObject *slice;
-	ListNode *listnode;
 	int_t len;
 
-	len = length(list);
+	len = list->size;
 
 	if (start < 0)
 		start += len;
@@ -387,11 +633,10 @@ static ListObject *list_slice(ListObject *list, int_t start, int_t end)
 		end = len;
 
 	if ((slice = (ListObject *)obj_alloc(LIST_T)) != NULL) {
-		for (int_t i = start; i < end; i++) {
-			listnode = listtype.item(list, i);
-			listtype.append(slice, obj_copy(listnode->obj));
-			obj_decref(listnode);
-		}
+		if (end > start)
+			reserve(slice, end - start);
+		for (int_t i = start; i < end; i++)
+			listtype.append(slice, obj_copy(list->item[i]));
 	} else
 		slice = (ListObject *)obj_alloc(NONE_T);
 
@@ -406,28 +651,20 @@ static ListObject *list_slice(ListObject *list, int_t start, int_t end)
  */
 static void list_append_object(ListObject *list, Object *obj)
 {
-	ListNode *listnode, *tail;
-
-	if ((listnode = (ListNode *)obj_create(LISTNODE_T, obj)) == NULL)
+	if (reserve(list, list->size + 1) == false)
 		return;
 
-	if (list->head == NULL) {  /* append to empty list */
-		list->head = listnode;
-		list->tail = listnode;
-	} else {  /* append to list which already has one of more listnodes */
-		tail = list->tail;
-		listnode->prev = tail;
-		tail->next = listnode;
-		list->tail = listnode;
-	}
+	HEADER(list)->lists += isContainer(obj);
+
+	list->item[list->size++] = obj;
 }
 
 
-/* Insert an object before the listnode with index number 'index'.
+/* Insert an object before the object with index number 'index'.
  *
  * Index is silently adjusted to the nearest possible value.
  * A negative index counts back from the end of the list. Index -1
- * points to the last listnode.
+ * points to the last object.
  *
  * list		list to insert object into
  * index	insert object before this index number
@@ -435,48 +672,31 @@ static void list_append_object(ListObject *list, Object *obj)
  */
 static void list_insert_object(ListObject *list, int_t index, Object *obj)
 {
-	ListNode *listnode, *iptr;
-	int_t len;
-
-	if ((listnode = (ListNode *)obj_create(LISTNODE_T, obj)) == NULL)
+	if (reserve(list, list->size + 1) == false)
 		return;
 
-	if (list->head == NULL) {  /* insert in empty list */
-		list->head = listnode;
-		list->tail = listnode;
-	} else {  /* insert in list which already has one or more listnodes */
-		len = length(list);
-
-		if (index < 0)
-			index += len;
-
-		if (index <= 0) {  /* insert before first listnode */
-			listnode->next = list->head;
-			listnode->next->prev = listnode;
-			listnode->prev = NULL;
-			list->head = listnode;
-		} else if (index >= len) {  /* insert after last listnode */
-			iptr = list->tail;
-			listnode->prev = iptr;
-			iptr->next = listnode;
-			list->tail = listnode;
-		} else {  /* insert somewhere in the middle */
-			for (iptr = list->head; index--; iptr = iptr->next)
-				;
-			/* insert before iptr */
-			listnode->next = iptr;
-			listnode->prev = iptr->prev;
-			listnode->next->prev = listnode;
-			listnode->prev->next = listnode;
-		}
-	}
+	HEADER(list)->lists += isContainer(obj);
+
+	if (index < 0)
+		index += list->size;
+
+	if (index < 0)
+		index = 0;
+	else if (index > list->size)
+		index = list->size;
+
+	/* shift the objects from index onwards one position to the right */
+	memmove(&list->item[index + 1], &list->item[index], (list->size - index) * sizeof(Object *));
+
+	list->item[index] = obj;
+	list->size++;
 }
 
 
-/* Remove the listnode with index number 'index' from a list.
+/* Remove the object with index number 'index' from a list.
  *
  * Index must exist (numbering starts at 0). A negative index counts back
- * from the end of the list. Index -1 points to the last listnode.
+ * from the end of the list. Index -1 points to the last object.
  *
  * list		list to remove object from
  * index	index number of object to remove
@@ -484,40 +704,187 @@ static void list_insert_object(ListObject *list, int_t index, Object *obj)
  */
 static Object *list_remove_object(ListObject *list, int_t index)
 {
-	ListNode *listnode;
-	Object *obj = NULL;
-	int_t len, i;
-
-	len = length(list);
+	Object *obj;
 
 	if (index < 0)
-		index += len;  /* negative index */
+		index += list->size;  /* negative index */
 
-	if (index < 0 || index >= len)
+	if (index < 0 || index >= list->size)
 		return obj_alloc(NONE_T);  /* IndexError: index out of range */
 
-	for (i = 0, listnode = list->head; listnode; i++, listnode = listnode->next) {
-		if (i == index) {
-			obj = listnode->obj;
-			if (list->head == list->tail) {  /* list contains only 1 listnode */
-				list->head = NULL;
-				list->tail = NULL;
-			} else if (listnode->prev == NULL) {  /* at least 2 listnodes, remove first */
-				list->head = listnode->next;
-				listnode->next->prev = NULL;
-			} else if (listnode->next == NULL) {  /* at least 2 listnodes, remove last */
-				list->tail = listnode->prev;
-				listnode->prev->next = NULL;
-			} else {  /* at least 3 nodes, listnode is not first or last */
-				listnode->prev->next = listnode->next;
-				listnode->next->prev = listnode->prev;
-			}
-			obj_incref(obj);  /* avoid that obj (= return value) is released */
-			obj_decref(listnode);
+	if (unshare(list) == false)
+		return obj_alloc(NONE_T);
+
+	obj = list->item[index];
+
+	HEADER(list)->lists -= isContainer(obj);
+
+	/* shift the objects after index one position to the left */
+	list->size--;
+	memmove(&list->item[index], &list->item[index + 1], (list->size - index) * sizeof(Object *));
+
+	return obj;  /* the reference of the list is handed over to the caller */
+}
+
+
+/* Comparators for sorting, return true if op1 < op2. If all objects in a
+ * list have the same type their values are compared directly. Only for
+ * lists with mixed types obj_lss() is used.
+ */
+static bool less_char(Object *op1, Object *op2)
+{
+	return char_value(op1) < char_value(op2);
+}
+
+
+static bool less_int(Object *op1, Object *op2)
+{
+	return int_value(op1) < int_value(op2);
+}
+
+
+static bool less_float(Object *op1, Object *op2)
+{
+	return ((FloatObject *)op1)->fval < ((FloatObject *)op2)->fval;
+}
+
+
+static bool less_str(Object *op1, Object *op2)
+{
+	return strtype.compare((StrObject *)op1, (StrObject *)op2) < 0;
+}
+
+
+static bool less_any(Object *op1, Object *op2)
+{
+	Object *obj = obj_lss(op1, op2);
+	bool less = obj_as_bool(obj);
+
+	obj_decref(obj);
+
+	return less;
+}
+
+
+/* Sort the objects in list 'item' from 'low' up to 'high' by insertion.
+ */
+static void insertion_sort(Object **item, int_t low, int_t high, bool (*less)(Object *, Object *))
+{
+	for (int_t i = low + 1; i < high; i++) {
+		Object *obj = item[i];
+		int_t j = i;
+
+		for (; j > low && less(obj, item[j - 1]); j--)  /* equal objects keep their order */
+			item[j] = item[j - 1];
+
+		item[j] = obj;
+	}
+}
+
+
+/* Merge the sorted ranges low..middle and middle..high of 'item' via
+ * buffer 'tmp'. Only the left range is copied to the buffer.
+ */
+static void merge(Object **item, Object **tmp, int_t low, int_t middle, int_t high, bool (*less)(Object *, Object *))
+{
+	int_t i = 0, j = middle, k = low, n = middle - low;
+
+	if (less(item[middle], item[middle - 1]) == false)
+		return;  /* already in order */
+
+	memcpy(tmp, &item[low], n * sizeof(Object *));
+
+	while (i < n && j < high)
+		item[k++] = less(item[j], tmp[i]) ? item[j++] : tmp[i++];  /* on equal take the left one, keeps sort stable */
+
+	while (i < n)
+		item[k++] = tmp[i++];
+}
+
+
+/* Sort the objects in a list in ascending order.
+ *
+ * The sort is stable: equal objects keep their order. Runs of SORTRUN
+ * objects are sorted by insertion, then the runs are merged bottom-up
+ * (O(n log n)).
+ */
+static void list_sort(ListObject *list)
+{
+	bool (*less)(Object *, Object *);
+	objecttype_t type;
+	Object **tmp;
+	int_t n = list->size;
+
+	if (n < 2 || unshare(list) == false)
+		return;
+
+	type = TYPE(list->item[0]);
+
+	for (int_t i = 1; i < n; i++)
+		if (TYPE(list->item[i]) != type) {
+			type = NONE_T;  /* mixed types */
 			break;
 		}
+
+	switch (type) {
+		case CHAR_T:
+			less = less_char;
+			break;
+		case INT_T:
+			less = less_int;
+			break;
+		case FLOAT_T:
+			less = less_float;
+			break;
+		case STR_T:
+			less = less_str;
+			break;
+		default:
+			less = less_any;
 	}
-	return obj;
+
+	for (int_t low = 0; low < n; low += SORTRUN)
+		insertion_sort(list->item, low, low + SORTRUN < n ? low + SORTRUN : n, less);
+
+	if (n <= SORTRUN)
+		return;
+
+	if ((tmp = malloc(n * sizeof(Object *))) == NULL) {
+		raise(OutOfMemoryError);
+		return;
+	}
+
+	for (int_t width = SORTRUN; width < n; width *= 2)
+		for (int_t low = 0; low + width < n; low += 2 * width)
+			merge(list->item, tmp, low, low + width, low + 2 * width < n ? low + 2 * width : n, less);
+
+	free(tmp);
+}
+
+
+/* Start iterating over a list.
+ *
+ * The length is only determined once. Objects which are appended while
+ * iterating are not visited.
+ */
+static void list_begin(ListObject *list, CursorObject *cursor)
+{
+	cursor->index = 0;
+	cursor->end = list->size;
+}
+
+
+/* Return a listnode which refers to the next object of the list, so the
+ * object can be modified via the variable of a for-in loop.
+ *
+ * return	new listnode-object or NULL if there are no objects left
+ */
+static Object *list_next(CursorObject *cursor)
+{
+	if (cursor->index >= cursor->end)
+		return NULL;
+
+	return obj_create(LISTNODE_T, cursor->sequence, cursor->index++);
 }
 
 
@@ -531,20 +898,39 @@ ListType listtype = {
 	.set = list_set,
 	.vset =  (void (*)(Object *, va_list))list_vset,
 	.method = (Object *(*)(Object *, char *, Array *))list_method,
+	.begin = (void (*)(Object *, struct cursor *))list_begin,
+	.next = list_next,
 
 	.length = list_length,
 	.item = list_item,
+	.store = list_store,
+	.update = list_update,
 	.slice = list_slice,
-	.concat = list_concat,
-	.repeat = list_repeat,
-	.eql = list_eql,
-	.neq = list_neq,
+	.iconcat = list_iconcat,
+	.irepeat = list_irepeat,
 	.insert = list_insert_object,
 	.append = list_append_object,
-	.remove = list_remove_object
+	.remove = list_remove_object,
+	.sort = list_sort
 	};
 
 
+/* Register the kernels for the binary operators on lists (see object.h).
+ */
+void list_register(void)
+{
+	obj_register(OBJ_ADD, LIST_T, LIST_T, (kernel_t)list_concat);
+
+	for (objecttype_t type = CHAR_T; type <= FLOAT_T; type++) {
+		obj_register(OBJ_MUL, LIST_T, type, list_repeat);
+		obj_register(OBJ_MUL, type, LIST_T, list_repeat);
+	}
+
+	obj_register(OBJ_EQL, LIST_T, LIST_T, (kernel_t)list_eql);
+	obj_register(OBJ_NEQ, LIST_T, LIST_T, (kernel_t)list_neq);
+}
+
+
 /* Create a new empty listnode.
  *
  * return	new listnode-object or none-object in case of error
@@ -553,54 +939,64 @@ static ListNode *listnode_alloc(void)
 {
 	ListNode *obj;
 
-	if ((obj = calloc(1, sizeof(ListNode))) != NULL) {
+	if ((obj = pool_alloc(sizeof(ListNode))) != NULL) {
 		obj->typeobj = (TypeObject *)&listnodetype;
 		obj->type = LISTNODE_T;
 		obj->refcount = 0;
 
-		obj->next = NULL;
-		obj->prev = NULL;
-		obj->obj = NULL;
+		obj->list = NULL;
+		obj->index = 0;
 	}
 	return obj;  /* returns NULL if alloc failed */
 }
 
 
-/* Free a listnode, and release the object it references.
+/* Free a listnode, and release the list it refers to.
  *
  */
 static void listnode_free(ListNode *listnode)
 {
-	if (listnode->obj)
-		obj_decref(listnode->obj);
+	if (listnode->list)
+		obj_decref(listnode->list);
 
 	*listnode = (const ListNode) { 0 };  /* clear the object struct, facilitates debugging */
 
-	free(listnode);
+	pool_free(listnode, sizeof(ListNode));
 }
 
 
-/* Print listnode content.
+/* Print the element the listnode refers to.
  *
  */
 static void listnode_print(FILE *fp, ListNode *listnode)
 {
-	obj_print(fp, listnode->obj);
+	Object *obj = obj_from_listnode(listnode);
+
+	obj_print(fp, obj);
+	obj_decref(obj);
 }
 
 
+/* Store an object in the list at the position the listnode refers to.
+ *
+ * The list takes over the reference to obj from the caller.
+ */
 static void listnode_set(ListNode *listnode, Object *obj)
 {
-	if (listnode->obj)
-		obj_decref(listnode->obj);
-
-	listnode->obj = obj;
+	listtype.store(listnode->list, listnode->index, obj);
 }
 
 
+/* Let a new listnode refer to a position in a list.
+ *
+ * argp		list-object and index number
+ */
 static void listnode_vset(ListNode *listnode, va_list argp)
 {
-	listnode_set(listnode, va_arg(argp, Object *));
+	listnode->list = va_arg(argp, ListObject *);
+	listnode->index = va_arg(argp, int_t);
+
+	obj_incref(listnode->list);
 }
 
 
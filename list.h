@@ -1,9 +1,17 @@
 /* list.h
  *
- * A list contains 0 of more listnodes. The list object is a header which
- * points to the first listnode. The last listnode points to the header.
- * Every listnode points to the object which is stored in the list. In
- * this way the list structure is agnostic of the object type stored.
+ * A list contains 0 of more objects. The list object is a header which
+ * points to a contiguous array with pointers to the objects. The array
+ * grows when needed, the number of objects in use is kept in the header.
+ * So retrieving an object by index or determining the length of a list
+ * does not require walking through the list. As only pointers are stored
+ * the list structure is agnostic of the object type stored.
+ * The array can be shared by several lists until one of them is modified
+ * (copy on write), see list.c.
+ *
+ * A listnode refers to the element at a certain position in a list. The
+ * variable of a for-in loop is bound to a listnode, so assigning to this
+ * variable modifies the list.
  *
  * 2016	K.W.E. de Lange
  */
@@ -14,39 +22,52 @@
 
 typedef struct listobject {
 	OBJ_HEAD;
-	struct listnode *head;	/* first listnode in the list, NULL for empty list */
-	struct listnode *tail;	/* last listnode in the list, NULL for empty list */
+	int_t size;				/* number of objects in the list */
+	int_t capacity;			/* number of objects which fit in array item */
+	Object **item;			/* array with pointers to the objects, NULL for empty list */
 } ListObject;
 
+/* Header in front of the array with pointers to the objects.
+ */
+typedef struct {
+	int_t refcount;			/* number of lists sharing the array */
+	int_t lists;			/* number of lists, dicts and sets, if > 0 never share the array */
+	Object *element[];		/* this is where ListObject.item points to */
+} ListArray;
+
 typedef struct listnode {
 	OBJ_HEAD;
-	struct listnode *next;	/* next listnode in the list, NULL for last */
-	struct listnode *prev;	/* previous listnode in the list, NULL for first */
-	struct object *obj;  	/* object which is stored in the list */
+	ListObject *list;		/* list which holds the element */
+	int_t index;			/* position of the element in the list */
 } ListNode;
 
 typedef struct {
 	TYPE_HEAD;
 	Object *(*length)(ListObject *obj);
-	ListNode *(*item)(ListObject *str, int_t index);
+	Object *(*item)(ListObject *list, int_t index);
+	void (*store)(ListObject *list, int_t index, Object *obj);
+	Object *(*update)(ListObject *list, int_t index, Object *(*operation)(Object *, Object *), Object *value);
 	ListObject *(*slice)(ListObject *obj, int_t start, int_t end);
-	Object *(*concat)(ListObject *op1, ListObject *op2);
-	Object *(*repeat)(Object *op1, Object *op2);
-	Object *(*eql)(ListObject *op1, ListObject *op2);
-	Object *(*neq)(ListObject *op1, ListObject *op2);
+	void (*iconcat)(ListObject *op1, ListObject *op2);
+	void (*irepeat)(ListObject *op1, Object *n);
 	void (*insert)(ListObject *list, int_t index, Object *obj);
 	void (*append)(ListObject *list, Object *obj);
 	Object *(*remove)(ListObject *list, int_t index);
+	void (*sort)(ListObject *list);
 } ListType;
 
 extern ListType listtype;
 
+extern void list_register(void);
+
 typedef struct {
 	TYPE_HEAD;
 } ListNodeType;
 
 extern ListNodeType listnodetype;
 
-#define obj_from_listnode(o)	(((ListNode *)o)->obj)
+/* Return the element a listnode refers to, its refcount is increased by 1.
+ */
+#define obj_from_listnode(o)	listtype.item(((ListNode *)(o))->list, ((ListNode *)(o))->index)
 
 #endif
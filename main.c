@@ -13,14 +13,21 @@
 
 #include "identifier.h"
 #include "object.h"
+#include "compile.h"
 #include "config.h"
 #include "visit.h"
 #include "parse.h"
+#include "optimize.h"
+#include "frame.h"
+#include "pool.h"
+#include "vm.h"
 
 
 Config config = {				/* global configuration variables */
 	.debug = NODEBUG,
-	.tabsize = TABSIZE
+	.tabsize = TABSIZE,
+	.bytecode = 0,
+	.optimize = OPTIMIZE
 };
 
 
@@ -32,6 +39,7 @@ static void usage(char *executable, FILE *stream)
 	fprintf(stream, "usage: %s [options] module\n", executable);
 	fprintf(stream, "module: name of file containing code to execute\n");
 	fprintf(stream, "options\n");
+	fprintf(stream, "-b = compile to bytecode and execute via the virtual machine\n");
 	#ifdef DEBUG
 	fprintf(stream, "-d[detail] = show debug info\n");
 	fprintf(stream, "    detail = sum of options (default = %d)\n", DEBUGASTEXEC);
@@ -40,10 +48,13 @@ static void usage(char *executable, FILE *stream)
 	fprintf(stream, "    option %2d: show memory allocation\n", DEBUGALLOC);
 	fprintf(stream, "    option %2d: show abstract syntax tree after parsing and stop\n", DEBUGASTSTOP);
 	fprintf(stream, "    option %2d: show abstract syntax tree after parsing and execute\n", DEBUGASTEXEC);
-	fprintf(stream, "    option %2d: dump identifier and object table to stdout after program end\n", DEBUGDUMP);
-	fprintf(stream, "    option %2d: dump identifier and object table to disk after program end\n", DEBUGDUMPFILE);
+	fprintf(stream, "    option %2d: dump identifier, object and pool table to stdout after program end\n", DEBUGDUMP);
+	fprintf(stream, "    option %2d: dump identifier, object and pool table to disk after program end\n", DEBUGDUMPFILE);
+	fprintf(stream, "    option %2d: show bytecode after compilation (with -b)\n", DEBUGBYTECODE);
 	#endif  /* DEBUG */
 	fprintf(stream, "-h = show usage information\n");
+	fprintf(stream, "-O[level] = set optimization level\n");
+	fprintf(stream, "    level = 0 (none), 1 (constant folding) or 2 (plus constant propagation) (default = %d)\n", OPTIMIZE);
 	fprintf(stream, "-t[tabsize] = set tab size in spaces\n");
 	fprintf(stream, "    tabsize = >= 1 (default = %d)\n", TABSIZE);
 	fprintf(stream, "-v = show version information\n");
@@ -65,6 +76,9 @@ int	main(int argc, char **argv)
 	while (--argc > 0 && (*++argv)[0] == '-') {
 		ch = *++argv[0];
 		switch (ch) {
+			case 'b':
+				config.bytecode = 1;
+				break;
 			#ifdef DEBUG
 			case 'd':
 				if (isdigit(*++argv[0]))
@@ -76,6 +90,12 @@ int	main(int argc, char **argv)
 			case 'h':
 				usage(executable, stdout);
 				return 0;
+			case 'O':
+				if (isdigit(*++argv[0]))
+					config.optimize = (int)str_to_int(&(*argv[0]));
+				else
+					config.optimize = OPTIMIZE;
+				break;
 			case 't':
 				if (isdigit(*++argv[0])) {
 					config.tabsize = (int)str_to_int(&(*argv[0]));
@@ -102,9 +122,11 @@ int	main(int argc, char **argv)
 		fprintf(stderr, "%s: module name missing\n", executable);
 		usage(executable, stderr);
 	} else if (argc == 1) {
-		Stack *s = stack.alloc(10);
+		Stack *s = stack.alloc(STACKSIZE);
 		int returncode = 0;
 
+		obj_init();  /* fill the dispatch matrix for binary operators */
+
 		Node *root = parse(module.import(*argv));  /* step 1: parse module(s) */
 
 		if (config.debug & (DEBUGASTEXEC | DEBUGASTSTOP))
@@ -115,14 +137,22 @@ int	main(int argc, char **argv)
 		config.debug = NODEBUG;  /* no debug output when checking */
 
 		check(root);  /* step 2: do code checks */
-		scope.remove_level();
 
 		config.debug = tmp.debug;
 
-		visit(root, s);  /* step 3: visit = execute the AST */
+		optimize(root);  /* step 2a: rewrite the checked AST */
+
+		display.enter(0, scope.local_slots());  /* frame for the global variables */
+
+		if (config.bytecode) {  /* step 3: compile the AST and execute the bytecode */
+			Object *obj = execute(compile_module(root));
+			if (obj)
+				stack_push(s, obj);
+		} else
+			visit(root, s);  /* step 3: visit = execute the AST */
 
 		if (!stack.is_empty(s)) {  /* check for return value */
-			Object *obj = stack.pop(s);
+			Object *obj = stack_pop(s);
 			if (isNumber(obj))
 				returncode = obj_as_int(obj);
 			obj_decref(obj);
@@ -131,19 +161,22 @@ int	main(int argc, char **argv)
 		#ifdef DEBUG
 		if (config.debug & (DEBUGDUMP | DEBUGDUMPFILE)) {
 			printf("\nstack content = %ld value(s)\n", s->top + 1);
+			printf("stack high water mark = %ld value(s)\n", s->highwater);
 
 			while (stack.is_empty(s) == false)
-				obj_print(stdout, stack.pop(s));
+				obj_print(stdout, stack_pop(s));
 		}
 
 		if (config.debug & DEBUGDUMP) {
 			dump_identifiers_to_file(stdout);
 			dump_objects_to_file(stdout);
+			dump_pools_to_file(stdout);
 		}
 
 		if (config.debug & DEBUGDUMPFILE) {
 			dump_identifiers();
 			dump_objects();
+			dump_pools();
 		}
 		#endif  /* DEBUG */
 
@@ -0,0 +1,1004 @@
+/* numarray.c
+ *
+ * Array object operations
+ *
+ * See numarray.h for an explanation on the data structures for arrays.
+ *
+ * The type of the values (the kind) is determined when an array is filled:
+ * float if at least one of the numbers is a float, else integer. Values
+ * which are stored or appended later are converted to the kind of the
+ * array, just like a value assigned to an int or float variable.
+ *
+ * Copying an array shares the block with values, every function which
+ * modifies an array first calls unshare(). Arrays never contain objects,
+ * so a private copy is just a memcpy().
+ *
+ * The arithmetic operators and the reductions are done by kernels: loops
+ * over plain int_t or float_t pointers, without function calls or
+ * branches in the loop body. Compilers vectorize these at -O2 or -O3. The
+ * float reductions keep LANES partial results, because the compiler may
+ * not change the order in which floats are added by itself.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "object.h"
+#include "error.h"
+#include "none.h"
+#include "number.h"
+#include "list.h"
+#include "range.h"
+#include "numarray.h"
+#include "cursor.h"
+
+
+#define NUMARRAYINCREMENT	16	/* minimal number of values to add when the array needs to grow */
+#define LANES				8	/* number of partial results in a float reduction */
+
+#define BLOCK(array)	((NumArrayBlock *)((char *)(array)->data - offsetof(NumArrayBlock, value)))
+#define WIDTH(kind)		((kind) == FLOAT_T ? sizeof(float_t) : sizeof(int_t))
+
+
+/* Create a new empty array-object.
+ *
+ * return	new array-object or NULL in case of error
+ */
+static NumArrayObject *numarray_alloc(void)
+{
+	NumArrayObject *obj;
+
+	if ((obj = calloc(1, sizeof(NumArrayObject))) != NULL) {
+		obj->typeobj = (TypeObject *)&numarraytype;
+		obj->type = NUMARRAY_T;
+		obj->refcount = 0;
+
+		obj->kind = INT_T;
+		obj->size = 0;
+		obj->capacity = 0;
+		obj->data = NULL;
+	}
+	return obj;  /* returns NULL if alloc failed */
+}
+
+
+/* Give an array a private block if it shares its block with other arrays.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool unshare(NumArrayObject *array)
+{
+	NumArrayBlock *block;
+
+	if (array->data == NULL || BLOCK(array)->refcount == 1)
+		return true;
+
+	if ((block = malloc(sizeof(NumArrayBlock) + array->capacity * WIDTH(array->kind))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	block->refcount = 1;
+	memcpy(block->value, array->data, array->size * WIDTH(array->kind));
+
+	BLOCK(array)->refcount--;
+
+	array->data = block->value;
+
+	return true;
+}
+
+
+/* Make sure an array can hold at least 'size' values, and that it can be
+ * modified because its block is not shared.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool reserve(NumArrayObject *array, int_t size)
+{
+	NumArrayBlock *block;
+	int_t capacity;
+
+	if (unshare(array) == false)
+		return false;
+
+	if (size <= array->capacity)
+		return true;
+
+	capacity = array->capacity * 2;
+
+	if (capacity < size)
+		capacity = size < NUMARRAYINCREMENT ? NUMARRAYINCREMENT : size;
+
+	if ((block = realloc(array->data ? BLOCK(array) : NULL, sizeof(NumArrayBlock) + capacity * WIDTH(array->kind))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	if (array->data == NULL)
+		block->refcount = 1;
+
+	array->data = block->value;
+	array->capacity = capacity;
+
+	return true;
+}
+
+
+/* Remove all values from an array. A shared block is left to the other
+ * arrays, a private block is released.
+ */
+static void clear(NumArrayObject *array)
+{
+	if (array->data) {
+		if (BLOCK(array)->refcount > 1)
+			BLOCK(array)->refcount--;
+		else
+			free(BLOCK(array));
+	}
+
+	array->data = NULL;
+	array->size = 0;
+	array->capacity = 0;
+}
+
+
+static void numarray_free(NumArrayObject *obj)
+{
+	clear(obj);
+
+	*obj = (const NumArrayObject) { 0 };  /* clear the object struct, facilitates debugging */
+
+	free(obj);
+}
+
+
+/* Print array content between square brackets.
+ *
+ */
+static void numarray_print(FILE *fp, NumArrayObject *obj)
+{
+	fprintf(fp, "[");
+
+	for (int_t i = 0; i < obj->size; i++) {
+		if (obj->kind == INT_T)
+			fprintf(fp, "%ld", obj->ival[i]);
+		else
+			fprintf(fp, "%.*G", 15, obj->fval[i]);
+		if (i < obj->size - 1)
+			fprintf(fp, ",");
+	}
+	fprintf(fp, "]");
+}
+
+
+/* Fill an empty array with the numbers in a list.
+ */
+static void fill(NumArrayObject *array, ListObject *list)
+{
+	objecttype_t kind = INT_T;
+
+	for (int_t i = 0; i < list->size; i++)
+		switch (TYPE(list->item[i])) {
+			case CHAR_T:
+			case INT_T:
+				break;
+			case FLOAT_T:
+				kind = FLOAT_T;
+				break;
+			default:
+				raise(ValueError, "cannot convert %s to array element", TYPENAME(list->item[i]));
+				return;
+		}
+
+	array->kind = kind;
+
+	if (list->size == 0 || reserve(array, list->size) == false)
+		return;
+
+	for (int_t i = 0; i < list->size; i++)
+		if (kind == INT_T)
+			array->ival[i] = obj_as_int(list->item[i]);
+		else
+			array->fval[i] = obj_as_float(list->item[i]);
+
+	array->size = list->size;
+}
+
+
+/* Replace the content of array 'dest' by the numbers of 'src'.
+ *
+ * An array is shared with dest, the integers of a range are calculated
+ * directly into dest.
+ *
+ * src		array, list with numbers or range
+ */
+static void numarray_set(NumArrayObject *dest, Object *src)
+{
+	NumArrayObject *array;
+	RangeObject *range;
+	int_t size;
+
+	if ((Object *)dest == src)
+		return;
+
+	obj_incref(src);  /* src may be held by dest */
+
+	clear(dest);
+	dest->kind = INT_T;
+
+	switch (TYPE(src)) {
+		case NUMARRAY_T:
+			array = (NumArrayObject *)src;
+			dest->kind = array->kind;
+			if (array->data) {
+				BLOCK(array)->refcount++;
+				dest->data = array->data;
+				dest->size = array->size;
+				dest->capacity = array->capacity;
+			}
+			break;
+		case LIST_T:
+			fill(dest, (ListObject *)src);
+			break;
+		case RANGE_T:
+			range = (RangeObject *)src;
+			size = range_length(range);
+			if (size == 0 || reserve(dest, size) == false)
+				break;
+			for (int_t i = 0; i < size; i++)
+				dest->ival[i] = range->start + i * range->step;
+			dest->size = size;
+			break;
+		default:
+			raise(ValueError, "cannot convert %s to array", TYPENAME(src));
+	}
+
+	obj_decref(src);
+}
+
+
+static void numarray_vset(NumArrayObject *obj, va_list argp)
+{
+	numarray_set(obj, va_arg(argp, Object *));
+}
+
+
+/* Return the number of values in an array.
+ *
+ * return	integer-object with the length
+ */
+static Object *numarray_length(NumArrayObject *array)
+{
+	return obj_int(array->size);
+}
+
+
+/* Convert a possibly negative index to a position in an array.
+ *
+ * return	position or -1 if the index is out of range
+ */
+static int_t position(NumArrayObject *array, int_t index)
+{
+	if (index < 0)
+		index += array->size;
+
+	if (index < 0 || index >= array->size) {
+		raise(IndexError);
+		return -1;
+	}
+	return index;
+}
+
+
+/* Return the value at position 'index' in a new number-object.
+ *
+ * return	number-object or none-object in case of error
+ */
+static Object *numarray_item(NumArrayObject *array, int_t index)
+{
+	if ((index = position(array, index)) < 0)
+		return obj_alloc(NONE_T);
+
+	if (array->kind == INT_T)
+		return obj_int(array->ival[index]);
+	else
+		return obj_create(FLOAT_T, array->fval[index]);
+}
+
+
+/* Store the value of number 'value' at position 'index'.
+ */
+static void numarray_store(NumArrayObject *array, int_t index, Object *value)
+{
+	if ((index = position(array, index)) < 0 || unshare(array) == false)
+		return;
+
+	if (array->kind == INT_T)
+		array->ival[index] = obj_as_int(value);
+	else
+		array->fval[index] = obj_as_float(value);
+}
+
+
+/* array[index] = array[index] (operation) value
+ *
+ * return	number-object with the result
+ */
+static Object *numarray_update(NumArrayObject *array, int_t index, Object *(*operation)(Object *, Object *), Object *value)
+{
+	Object *item, *result;
+
+	item = numarray_item(array, index);
+	result = operation(item, value);
+	obj_decref(item);
+
+	numarray_store(array, index, result);
+
+	return result;
+}
+
+
+/* Return a new array with the values from position start up to end.
+ *
+ * return	new array-object
+ */
+static NumArrayObject *numarray_slice(NumArrayObject *array, int_t start, int_t end)
+{
+	NumArrayObject *slice;
+	int_t len = array->size;
+
+	if (start < 0)
+		start += len;
+
+	if (end < 0)
+		end += len;
+
+	if (start < 0)
+		start = 0;
+
+	if (end >= len)
+		end = len;
+
+	if ((slice = (NumArrayObject *)obj_alloc(NUMARRAY_T)) == NULL)
+		return (NumArrayObject *)obj_alloc(NONE_T);
+
+	slice->kind = array->kind;
+
+	if (end > start && reserve(slice, end - start)) {
+		memcpy(slice->data, (char *)array->data + start * WIDTH(array->kind), (end - start) * WIDTH(array->kind));
+		slice->size = end - start;
+	}
+	return slice;
+}
+
+
+/* Check if an array contains a number.
+ */
+static bool numarray_contains(NumArrayObject *array, Object *value)
+{
+	int_t i;
+	float_t f;
+
+	if (isNumber(value) == false)
+		return false;
+
+	if (array->kind == INT_T && TYPE(value) != FLOAT_T) {
+		i = obj_as_int(value);
+		for (int_t n = 0; n < array->size; n++)
+			if (array->ival[n] == i)
+				return true;
+	} else {
+		f = obj_as_float(value);
+		for (int_t n = 0; n < array->size; n++)
+			if ((array->kind == INT_T ? (float_t)array->ival[n] : array->fval[n]) == f)
+				return true;
+	}
+	return false;
+}
+
+
+/* Add a number at the end of an array.
+ */
+static void numarray_append(NumArrayObject *array, Object *value)
+{
+	if (reserve(array, array->size + 1) == false)
+		return;
+
+	array->size++;
+
+	numarray_store(array, -1, value);
+}
+
+
+/* An operand of an arithmetic operation or a reduction. For an array
+ * 'values' points to its values, converted to the kind of the result if
+ * needed. For a number 'ival' or 'fval' holds its value.
+ */
+typedef struct {
+	bool vector;			/* true if the operand is an array */
+	int_t size;				/* number of values of an array */
+	const void *values;		/* values of an array */
+	void *buffer;			/* values converted to the other kind, released by release() */
+	int_t ival;
+	float_t fval;
+} Operand;
+
+
+/* Return the kind of the values in an array or of a number.
+ */
+static objecttype_t kind_of(Object *obj)
+{
+	if (TYPE(obj) == NUMARRAY_T)
+		return ((NumArrayObject *)obj)->kind;
+
+	return TYPE(obj) == FLOAT_T ? FLOAT_T : INT_T;
+}
+
+
+/* Prepare 'obj' as operand for an operation whose result is of 'kind'.
+ *
+ * return	true if successful, false if out of memory
+ */
+static bool operand(Operand *op, Object *obj, objecttype_t kind)
+{
+	NumArrayObject *array;
+	void *buffer;
+
+	*op = (Operand) { 0 };
+
+	if (TYPE(obj) != NUMARRAY_T) {
+		if (kind == INT_T)
+			op->ival = obj_as_int(obj);
+		else
+			op->fval = obj_as_float(obj);
+		return true;
+	}
+
+	array = (NumArrayObject *)obj;
+
+	op->vector = true;
+	op->size = array->size;
+	op->values = array->data;
+
+	if (array->kind == kind || array->size == 0)
+		return true;
+
+	if ((buffer = malloc(array->size * WIDTH(kind))) == NULL) {
+		raise(OutOfMemoryError);
+		return false;
+	}
+
+	if (kind == FLOAT_T)
+		for (int_t i = 0; i < array->size; i++)
+			((float_t *)buffer)[i] = array->ival[i];
+	else
+		for (int_t i = 0; i < array->size; i++)
+			((int_t *)buffer)[i] = array->fval[i];
+
+	op->values = op->buffer = buffer;
+
+	return true;
+}
+
+
+static void release(Operand *op)
+{
+	free(op->buffer);
+}
+
+
+/* Check if an operand is or contains a zero.
+ */
+static bool zero(Operand *op, objecttype_t kind)
+{
+	bool found = false;
+
+	if (op->vector == false)
+		return kind == INT_T ? op->ival == 0 : op->fval == 0;
+
+	if (kind == INT_T)
+		for (int_t i = 0; i < op->size; i++)
+			found |= ((const int_t *)op->values)[i] == 0;
+	else
+		for (int_t i = 0; i < op->size; i++)
+			found |= ((const float_t *)op->values)[i] == 0;
+
+	return found;
+}
+
+
+/* Element-wise kernels. For every operator there is a kernel for two
+ * arrays, for an array and a number (right) and for a number and an array
+ * (left), both for integers and for floats. The last function selects the
+ * kernel for the operands of 'result'. Result may be the left array itself
+ * (see inplace()), so the pointers are not declared restrict.
+ */
+#define ELEMENTWISE(name, operator)  \
+	static void name##_int(int_t *r, const int_t *a, const int_t *b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a[i] operator b[i];  \
+	}  \
+	static void name##_int_right(int_t *r, const int_t *a, int_t b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a[i] operator b;  \
+	}  \
+	static void name##_int_left(int_t *r, int_t a, const int_t *b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a operator b[i];  \
+	}  \
+	static void name##_float(float_t *r, const float_t *a, const float_t *b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a[i] operator b[i];  \
+	}  \
+	static void name##_float_right(float_t *r, const float_t *a, float_t b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a[i] operator b;  \
+	}  \
+	static void name##_float_left(float_t *r, float_t a, const float_t *b, int_t n)  \
+	{  \
+		for (int_t i = 0; i < n; i++)  \
+			r[i] = a operator b[i];  \
+	}  \
+	static void name(NumArrayObject *result, Operand *a, Operand *b)  \
+	{  \
+		if (result->kind == INT_T) {  \
+			if (a->vector && b->vector)  \
+				name##_int(result->ival, a->values, b->values, result->size);  \
+			else if (a->vector)  \
+				name##_int_right(result->ival, a->values, b->ival, result->size);  \
+			else  \
+				name##_int_left(result->ival, a->ival, b->values, result->size);  \
+		} else {  \
+			if (a->vector && b->vector)  \
+				name##_float(result->fval, a->values, b->values, result->size);  \
+			else if (a->vector)  \
+				name##_float_right(result->fval, a->values, b->fval, result->size);  \
+			else  \
+				name##_float_left(result->fval, a->fval, b->values, result->size);  \
+		}  \
+	}
+
+ELEMENTWISE(vadd, +)
+ELEMENTWISE(vsub, -)
+ELEMENTWISE(vmul, *)
+ELEMENTWISE(vdiv, /)
+
+
+/* result = op1 (operation) op2, where at least one of the operands is an
+ * array. Arrays must have the same length.
+ *
+ * return	new array-object with result or none-object in case of error
+ */
+static Object *arithmetic(void (*kernel)(NumArrayObject *, Operand *, Operand *), Object *op1, Object *op2, bool divide)
+{
+	NumArrayObject *result;
+	objecttype_t kind;
+	Operand a, b;
+	int_t size;
+
+	kind = (kind_of(op1) == FLOAT_T || kind_of(op2) == FLOAT_T) ? FLOAT_T : INT_T;
+
+	if (operand(&a, op1, kind) == false || operand(&b, op2, kind) == false) {
+		release(&a);
+		return obj_alloc(NONE_T);
+	}
+
+	size = a.vector ? a.size : b.size;
+
+	if (a.vector && b.vector && a.size != b.size) {
+		raise(ValueError, "arrays have different lengths: %ld and %ld", a.size, b.size);
+		result = NULL;
+	} else if (divide && zero(&b, kind)) {
+		raise(DivisionByZeroError);
+		result = NULL;
+	} else if ((result = (NumArrayObject *)obj_alloc(NUMARRAY_T)) != NULL) {
+		result->kind = kind;
+		if (size != 0 && reserve(result, size)) {
+			result->size = size;
+			kernel(result, &a, &b);
+		}
+	}
+
+	release(&a);
+	release(&b);
+
+	return result ? (Object *)result : obj_alloc(NONE_T);
+}
+
+
+static Object *numarray_add(Object *op1, Object *op2)
+{
+	return arithmetic(vadd, op1, op2, false);
+}
+
+
+static Object *numarray_sub(Object *op1, Object *op2)
+{
+	return arithmetic(vsub, op1, op2, false);
+}
+
+
+static Object *numarray_mul(Object *op1, Object *op2)
+{
+	return arithmetic(vmul, op1, op2, false);
+}
+
+
+static Object *numarray_div(Object *op1, Object *op2)
+{
+	return arithmetic(vdiv, op1, op2, true);
+}
+
+
+/* op1 = op1 (operation) op2, where op2 is an array of the same length or
+ * a number. The result is stored in the values of op1 and converted to the
+ * kind of op1, like for a compound assignment to a number variable. As no
+ * new block is claimed, a + b + c only needs memory for a single result
+ * (see obj_add_tmp()).
+ */
+static void inplace(void (*kernel)(NumArrayObject *, Operand *, Operand *), NumArrayObject *op1, Object *op2, bool divide)
+{
+	NumArrayObject *result;
+	Operand a, b;
+
+	if (op1->kind == INT_T && kind_of(op2) == FLOAT_T) {  /* calculate with floats, then truncate */
+		result = (NumArrayObject *)arithmetic(kernel, (Object *)op1, op2, divide);
+		if (TYPE(result) == NUMARRAY_T && unshare(op1))
+			for (int_t i = 0; i < op1->size; i++)
+				op1->ival[i] = result->fval[i];
+		obj_decref(result);
+		return;
+	}
+
+	if (unshare(op1) == false || operand(&b, op2, op1->kind) == false)
+		return;
+
+	if (b.vector && b.size != op1->size)
+		raise(ValueError, "arrays have different lengths: %ld and %ld", op1->size, b.size);
+	else if (divide && zero(&b, op1->kind))
+		raise(DivisionByZeroError);
+	else if (op1->size != 0) {
+		a = (Operand) { .vector = true, .size = op1->size, .values = op1->data };
+		kernel(op1, &a, &b);
+	}
+
+	release(&b);
+}
+
+
+static void numarray_iadd(NumArrayObject *op1, Object *op2)
+{
+	inplace(vadd, op1, op2, false);
+}
+
+
+static void numarray_isub(NumArrayObject *op1, Object *op2)
+{
+	inplace(vsub, op1, op2, false);
+}
+
+
+static void numarray_imul(NumArrayObject *op1, Object *op2)
+{
+	inplace(vmul, op1, op2, false);
+}
+
+
+static void numarray_idiv(NumArrayObject *op1, Object *op2)
+{
+	inplace(vdiv, op1, op2, true);
+}
+
+
+/* Reduction kernels.
+ */
+static int_t sum_int(const int_t *restrict a, int_t n)
+{
+	int_t sum = 0;
+
+	for (int_t i = 0; i < n; i++)
+		sum += a[i];
+
+	return sum;
+}
+
+
+static float_t sum_float(const float_t *restrict a, int_t n)
+{
+	float_t partial[LANES] = { 0 };
+	float_t sum = 0;
+	int_t i;
+
+	for (i = 0; i + LANES <= n; i += LANES)
+		for (int j = 0; j < LANES; j++)
+			partial[j] += a[i + j];
+
+	for (int j = 0; j < LANES; j++)
+		sum += partial[j];
+
+	for (; i < n; i++)
+		sum += a[i];
+
+	return sum;
+}
+
+
+static int_t dot_int(const int_t *restrict a, const int_t *restrict b, int_t n)
+{
+	int_t sum = 0;
+
+	for (int_t i = 0; i < n; i++)
+		sum += a[i] * b[i];
+
+	return sum;
+}
+
+
+static float_t dot_float(const float_t *restrict a, const float_t *restrict b, int_t n)
+{
+	float_t partial[LANES] = { 0 };
+	float_t sum = 0;
+	int_t i;
+
+	for (i = 0; i + LANES <= n; i += LANES)
+		for (int j = 0; j < LANES; j++)
+			partial[j] += a[i + j] * b[i + j];
+
+	for (int j = 0; j < LANES; j++)
+		sum += partial[j];
+
+	for (; i < n; i++)
+		sum += a[i] * b[i];
+
+	return sum;
+}
+
+
+/* Smallest (operator <) or largest (operator >) value, n must be > 0.
+ */
+#define EXTREME(name, operator)  \
+	static int_t name##_int(const int_t *restrict a, int_t n)  \
+	{  \
+		int_t value = a[0];  \
+		for (int_t i = 1; i < n; i++)  \
+			value = a[i] operator value ? a[i] : value;  \
+		return value;  \
+	}  \
+	static float_t name##_float(const float_t *restrict a, int_t n)  \
+	{  \
+		float_t partial[LANES], value;  \
+		int_t i;  \
+		for (int j = 0; j < LANES; j++)  \
+			partial[j] = a[0];  \
+		for (i = 0; i + LANES <= n; i += LANES)  \
+			for (int j = 0; j < LANES; j++)  \
+				partial[j] = a[i + j] operator partial[j] ? a[i + j] : partial[j];  \
+		value = partial[0];  \
+		for (int j = 1; j < LANES; j++)  \
+			value = partial[j] operator value ? partial[j] : value;  \
+		for (; i < n; i++)  \
+			value = a[i] operator value ? a[i] : value;  \
+		return value;  \
+	}
+
+EXTREME(min, <)
+EXTREME(max, >)
+
+
+/* Return the dot product of an array and another array of the same length.
+ *
+ * return	number-object or none-object in case of error
+ */
+static Object *dot(NumArrayObject *array, Object *other)
+{
+	objecttype_t kind;
+	Object *result;
+	Operand a, b;
+
+	if (TYPE(other) != NUMARRAY_T) {
+		raise(TypeError, "dot() expects an array, not %s", TYPENAME(other));
+		return obj_alloc(NONE_T);
+	}
+
+	kind = (array->kind == FLOAT_T || kind_of(other) == FLOAT_T) ? FLOAT_T : INT_T;
+
+	if (operand(&a, (Object *)array, kind) == false || operand(&b, other, kind) == false) {
+		release(&a);
+		return obj_alloc(NONE_T);
+	}
+
+	if (a.size != b.size) {
+		raise(ValueError, "arrays have different lengths: %ld and %ld", a.size, b.size);
+		result = obj_alloc(NONE_T);
+	} else if (kind == INT_T)
+		result = obj_int(dot_int(a.values, b.values, a.size));
+	else
+		result = obj_create(FLOAT_T, dot_float(a.values, b.values, a.size));
+
+	release(&a);
+	release(&b);
+
+	return result;
+}
+
+
+/* Execute a method on an array.
+ *
+ * obj			array-object for which method was called
+ * name			method name
+ * arguments	method arguments as array with pointers to objects
+ * return		object with method results or none-object in case of error
+ */
+static Object *numarray_method(NumArrayObject *obj, char *name, Array *arguments)
+{
+	Object *result;
+
+	if (strcmp("len", name) == 0 || strcmp("sum", name) == 0) {
+		if (arguments->size != 0) {
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+			result = obj_alloc(NONE_T);
+		} else if (name[0] == 'l')
+			result = numarraytype.length(obj);
+		else if (obj->kind == INT_T)
+			result = obj_int(sum_int(obj->ival, obj->size));
+		else
+			result = obj_create(FLOAT_T, sum_float(obj->fval, obj->size));
+	} else if (strcmp("min", name) == 0 || strcmp("max", name) == 0) {
+		if (arguments->size != 0) {
+			raise(SyntaxError, "method %s takes %d arguments", name, 0);
+			result = obj_alloc(NONE_T);
+		} else if (obj->size == 0) {
+			raise(ValueError, "%s() of empty array", name);
+			result = obj_alloc(NONE_T);
+		} else if (obj->kind == INT_T)
+			result = obj_int(name[1] == 'i' ? min_int(obj->ival, obj->size) : max_int(obj->ival, obj->size));
+		else
+			result = obj_create(FLOAT_T, name[1] == 'i' ? min_float(obj->fval, obj->size) : max_float(obj->fval, obj->size));
+	} else if (strcmp("dot", name) == 0) {
+		if (arguments->size != 1) {
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+			result = obj_alloc(NONE_T);
+		} else
+			result = dot(obj, arguments->element[0]);
+	} else if (strcmp("append", name) == 0) {
+		if (arguments->size != 1)
+			raise(SyntaxError, "method %s takes %d argument", name, 1);
+		else
+			numarraytype.append(obj, arguments->element[0]);
+		result = obj_alloc(NONE_T);
+	} else {
+		raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
+		result = obj_alloc(NONE_T);
+	}
+
+	return result;
+}
+
+
+/* Check if two arrays contain the same numbers.
+ */
+static bool numarray_cmp(NumArrayObject *op1, NumArrayObject *op2)
+{
+	if (op1->size != op2->size)
+		return false;
+
+	if (op1->kind == INT_T && op2->kind == INT_T)
+		return op1->size == 0 || memcmp(op1->data, op2->data, op1->size * sizeof(int_t)) == 0;
+
+	for (int_t i = 0; i < op1->size; i++)
+		if ((op1->kind == INT_T ? (float_t)op1->ival[i] : op1->fval[i]) != \
+			(op2->kind == INT_T ? (float_t)op2->ival[i] : op2->fval[i]))
+			return false;
+
+	return true;
+}
+
+
+/* Check if content of two arrays is equal.
+ *
+ * return	integer-object with value 1 if equal or value 0 if not equal
+ */
+static Object *numarray_eql(NumArrayObject *op1, NumArrayObject *op2)
+{
+	return obj_bool(numarray_cmp(op1, op2));
+}
+
+
+/* Check if content of two arrays is not equal.
+ *
+ * return	integer-object with value 0 if equal or value 1 if not equal
+ */
+static Object *numarray_neq(NumArrayObject *op1, NumArrayObject *op2)
+{
+	return obj_bool(!numarray_cmp(op1, op2));
+}
+
+
+static void numarray_begin(NumArrayObject *array, CursorObject *cursor)
+{
+	cursor->index = 0;
+	cursor->end = array->size;
+}
+
+
+/* Return a copy of the next value of an array.
+ *
+ * return	new number-object or NULL if there are no values left
+ */
+static Object *numarray_next(CursorObject *cursor)
+{
+	NumArrayObject *array = (NumArrayObject *)cursor->sequence;
+	int_t index = cursor->index;
+
+	if (index >= cursor->end || index >= array->size)
+		return NULL;
+
+	cursor->index++;
+
+	if (array->kind == INT_T)
+		return obj_create(INT_T, array->ival[index]);
+	else
+		return obj_create(FLOAT_T, array->fval[index]);
+}
+
+
+/* Array object API.
+ */
+NumArrayType numarraytype = {
+	.name = "array",
+	.alloc = (Object *(*)())numarray_alloc,
+	.free = (void (*)(Object *))numarray_free,
+	.print = (void (*)(FILE *, Object *))numarray_print,
+	.set = numarray_set,
+	.vset = (void (*)(Object *, va_list))numarray_vset,
+	.method = (Object *(*)(Object *, char *, Array *))numarray_method,
+	.begin = (void (*)(Object *, struct cursor *))numarray_begin,
+	.next = numarray_next,
+
+	.length = numarray_length,
+	.item = numarray_item,
+	.store = numarray_store,
+	.update = numarray_update,
+	.slice = numarray_slice,
+	.contains = numarray_contains,
+	.append = numarray_append,
+	.iadd = numarray_iadd,
+	.isub = numarray_isub,
+	.imul = numarray_imul,
+	.idiv = numarray_idiv
+	};
+
+
+/* Register the kernels for the binary operators on arrays (see object.h).
+ * The arithmetic operators combine two arrays, or an array with a number.
+ */
+void numarray_register(void)
+{
+	static const objecttype_t number[] = { CHAR_T, INT_T, FLOAT_T };
+
+	obj_register(OBJ_ADD, NUMARRAY_T, NUMARRAY_T, numarray_add);
+	obj_register(OBJ_SUB, NUMARRAY_T, NUMARRAY_T, numarray_sub);
+	obj_register(OBJ_MUL, NUMARRAY_T, NUMARRAY_T, numarray_mul);
+	obj_register(OBJ_DIV, NUMARRAY_T, NUMARRAY_T, numarray_div);
+
+	for (int i = 0; i < 3; i++) {
+		obj_register(OBJ_ADD, NUMARRAY_T, number[i], numarray_add);
+		obj_register(OBJ_ADD, number[i], NUMARRAY_T, numarray_add);
+		obj_register(OBJ_SUB, NUMARRAY_T, number[i], numarray_sub);
+		obj_register(OBJ_SUB, number[i], NUMARRAY_T, numarray_sub);
+		obj_register(OBJ_MUL, NUMARRAY_T, number[i], numarray_mul);
+		obj_register(OBJ_MUL, number[i], NUMARRAY_T, numarray_mul);
+		obj_register(OBJ_DIV, NUMARRAY_T, number[i], numarray_div);
+		obj_register(OBJ_DIV, number[i], NUMARRAY_T, numarray_div);
+	}
+
+	obj_register(OBJ_EQL, NUMARRAY_T, NUMARRAY_T, (kernel_t)numarray_eql);
+	obj_register(OBJ_NEQ, NUMARRAY_T, NUMARRAY_T, (kernel_t)numarray_neq);
+}
@@ -0,0 +1,57 @@
+/* numarray.h
+ *
+ * An array holds a series of integers or a series of floats. A list holds
+ * pointers to separate number objects; an array stores the values itself,
+ * one after the other in a single block of memory. This takes far less
+ * memory, and arithmetic on a whole array runs as a simple loop over
+ * contiguous values, which the C compiler can turn into SIMD instructions.
+ * A number object is only created when a single element is read.
+ *
+ * The block can be shared by several arrays until one of them is modified
+ * (copy on write), see numarray.c.
+ */
+#ifndef _NUMARRAY_
+#define _NUMARRAY_
+
+#include "object.h"
+
+typedef struct {
+	OBJ_HEAD;
+	objecttype_t kind;		/* type of the values, INT_T or FLOAT_T */
+	int_t size;				/* number of values in the array */
+	int_t capacity;			/* number of values which fit in the block */
+	union {					/* values, NULL for an empty array */
+		void *data;
+		int_t *ival;
+		float_t *fval;
+	};
+} NumArrayObject;
+
+/* Header in front of the values.
+ */
+typedef struct {
+	int_t refcount;			/* number of arrays sharing the block */
+	int_t unused;			/* pads the header to 16 bytes, so the values are aligned for SIMD */
+	unsigned char value[];	/* this is where NumArrayObject.data points to */
+} NumArrayBlock;
+
+typedef struct {
+	TYPE_HEAD;
+	Object *(*length)(NumArrayObject *array);
+	Object *(*item)(NumArrayObject *array, int_t index);
+	void (*store)(NumArrayObject *array, int_t index, Object *value);
+	Object *(*update)(NumArrayObject *array, int_t index, Object *(*operation)(Object *, Object *), Object *value);
+	NumArrayObject *(*slice)(NumArrayObject *array, int_t start, int_t end);
+	bool (*contains)(NumArrayObject *array, Object *value);
+	void (*append)(NumArrayObject *array, Object *value);
+	void (*iadd)(NumArrayObject *op1, Object *op2);
+	void (*isub)(NumArrayObject *op1, Object *op2);
+	void (*imul)(NumArrayObject *op1, Object *op2);
+	void (*idiv)(NumArrayObject *op1, Object *op2);
+} NumArrayType;
+
+extern NumArrayType numarraytype;
+
+extern void numarray_register(void);
+
+#endif
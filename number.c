@@ -21,13 +21,14 @@
 
 #include "number.h"
 #include "error.h"
+#include "pool.h"
 
 
 static Object *char_alloc(void)
 {
 	CharObject *obj;
 
-	if ((obj = calloc(1, sizeof(CharObject))) != NULL) {
+	if ((obj = pool_alloc(sizeof(CharObject))) != NULL) {
 		obj->typeobj = (TypeObject *)&chartype;
 		obj->type = CHAR_T;
 		obj->refcount = 0;
@@ -42,7 +43,7 @@ static Object *int_alloc(void)
 {
 	IntObject *obj;
 
-	if ((obj = calloc(1, sizeof(IntObject))) != NULL) {
+	if ((obj = pool_alloc(sizeof(IntObject))) != NULL) {
 		obj->typeobj = (TypeObject *)&inttype;
 		obj->type = INT_T;
 		obj->refcount = 0;
@@ -57,7 +58,7 @@ static Object *float_alloc(void)
 {
 	FloatObject *obj;
 
-	if ((obj = calloc(1, sizeof(FloatObject))) != NULL) {
+	if ((obj = pool_alloc(sizeof(FloatObject))) != NULL) {
 		obj->typeobj = (TypeObject *)&floattype;
 		obj->type = FLOAT_T;
 		obj->refcount = 0;
@@ -70,9 +71,23 @@ static Object *float_alloc(void)
 
 static void number_free(Object *obj)
 {
+	size_t size;
+
+	switch (TYPE(obj)) {
+		case CHAR_T:
+			size = sizeof(CharObject);
+			break;
+		case INT_T:
+			size = sizeof(IntObject);
+			break;
+		default:  /* FLOAT_T */
+			size = sizeof(FloatObject);
+			break;
+	}
+
 	*obj = (const Object) { 0 };  /* clear the object struct, facilitates debugging */
 
-	free(obj);
+	pool_free(obj, size);  /* return memory to the pool, not to the heap */
 }
 
 
@@ -149,310 +164,300 @@ static Object *number_method(Object *obj, char *name, Array *arguments)
  * else INT_T if at least one operand is INT_T
  * else CHAR_T
  */
-static objecttype_t coerce(Object *op1, Object *op2)
+static objecttype_t coerce(objecttype_t type1, objecttype_t type2)
 {
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
+	if (type1 == FLOAT_T || type2 == FLOAT_T)
 		return FLOAT_T;
-	else if (TYPE(op1) == INT_T || TYPE(op2) == INT_T)
+	else if (type1 == INT_T || type2 == INT_T)
 		return INT_T;
 	else
 		return CHAR_T;
 }
 
 
-static Object *number_add(Object *op1, Object *op2)
+/* Kernels for the binary operators (see object.h). There is a kernel per
+ * operator for every type of result, so the operands are converted to the
+ * result type without first having to look at their types. Which kernel is
+ * used for a combination of operand types is determined only once, by
+ * number_register().
+ */
+static Object *checked(Object *result)
 {
-	Object *result = NULL;
+	return result ? result : obj_alloc(NONE_T);  /* only NULL if out of memory */
+}
 
-	switch (coerce(op1, op2)) {
-		case CHAR_T:
-			result = obj_create(CHAR_T, obj_as_char(op1) + obj_as_char(op2));
-			break;
-		case INT_T:
-			result = obj_create(INT_T, obj_as_int(op1) + obj_as_int(op2));
-			break;
-		case FLOAT_T:
-			result = obj_create(FLOAT_T, obj_as_float(op1) + obj_as_float(op2));
-			break;
-		default:
-			assert(0);
-			break;
+
+#define ARITHMETIC(name, operator)  \
+	static Object *name##_char(Object *op1, Object *op2)  \
+	{  \
+		return obj_char(obj_as_char(op1) operator obj_as_char(op2));  \
+	}  \
+	static Object *name##_int(Object *op1, Object *op2)  \
+	{  \
+		return checked(obj_int(obj_as_int(op1) operator obj_as_int(op2)));  \
+	}  \
+	static Object *name##_float(Object *op1, Object *op2)  \
+	{  \
+		return checked(obj_create(FLOAT_T, obj_as_float(op1) operator obj_as_float(op2)));  \
 	}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
+#define COMPARISON(name, operator)  \
+	static Object *name##_char(Object *op1, Object *op2)  \
+	{  \
+		return obj_bool(obj_as_char(op1) operator obj_as_char(op2));  \
+	}  \
+	static Object *name##_int(Object *op1, Object *op2)  \
+	{  \
+		return obj_bool(obj_as_int(op1) operator obj_as_int(op2));  \
+	}  \
+	static Object *name##_float(Object *op1, Object *op2)  \
+	{  \
+		return obj_bool(obj_as_float(op1) operator obj_as_float(op2));  \
+	}
 
-	return result;
-}
+ARITHMETIC(add, +)
+ARITHMETIC(sub, -)
+ARITHMETIC(mul, *)
+COMPARISON(eql, ==)
+COMPARISON(neq, !=)
+COMPARISON(lss, <)
+COMPARISON(leq, <=)
+COMPARISON(gtr, >)
+COMPARISON(geq, >=)
 
 
-static Object *number_sub(Object *op1, Object *op2)
+static Object *div_char(Object *op1, Object *op2)
 {
-	Object *result = NULL;
-
-	switch (coerce(op1, op2)) {
-		case CHAR_T:
-			result = obj_create(CHAR_T, obj_as_char(op1) - obj_as_char(op2));
-			break;
-		case INT_T:
-			result = obj_create(INT_T, obj_as_int(op1) - obj_as_int(op2));
-			break;
-		case FLOAT_T:
-			result = obj_create(FLOAT_T, obj_as_float(op1) - obj_as_float(op2));
-			break;
-		default:
-			assert(0);
-			break;
+	if (obj_as_char(op2) == 0) {
+		raise(DivisionByZeroError);
+		return obj_alloc(NONE_T);
 	}
-
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
-
-	return result;
+	return obj_char(obj_as_char(op1) / obj_as_char(op2));
 }
 
 
-static Object *number_mul(Object *op1, Object *op2)
+static Object *div_int(Object *op1, Object *op2)
 {
-	Object *result = NULL;
-
-	switch (coerce(op1, op2)) {
-		case CHAR_T:
-			result = obj_create(CHAR_T, obj_as_char(op1) * obj_as_char(op2));
-			break;
-		case INT_T:
-			result = obj_create(INT_T, obj_as_int(op1) * obj_as_int(op2));
-			break;
-		case FLOAT_T:
-			result = obj_create(FLOAT_T, obj_as_float(op1) * obj_as_float(op2));
-			break;
-		default:
-			assert(0);
-			break;
+	if (obj_as_int(op2) == 0) {
+		raise(DivisionByZeroError);
+		return obj_alloc(NONE_T);
 	}
+	return checked(obj_int(obj_as_int(op1) / obj_as_int(op2)));
+}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
 
-	return result;
+static Object *div_float(Object *op1, Object *op2)
+{
+	if (obj_as_float(op2) == 0) {
+		raise(DivisionByZeroError);
+		return obj_alloc(NONE_T);
+	}
+	return checked(obj_create(FLOAT_T, obj_as_float(op1) / obj_as_float(op2)));
 }
 
 
-static Object *number_div(Object *op1, Object *op2)
+static Object *mod_char(Object *op1, Object *op2)
 {
-	Object *result = NULL;
-
-	if (obj_as_float(op2) == 0)
+	if (obj_as_char(op2) == 0) {
 		raise(DivisionByZeroError);
-	else
-		switch (coerce(op1, op2)) {
-			case CHAR_T:
-				result = obj_create(CHAR_T, obj_as_char(op1) / obj_as_char(op2));
-				break;
-			case INT_T:
-				result = obj_create(INT_T, obj_as_int(op1) / obj_as_int(op2));
-				break;
-			case FLOAT_T:
-				result = obj_create(FLOAT_T, obj_as_float(op1) / obj_as_float(op2));
-				break;
-			default:
-				assert(0);
-				break;
-		}
+		return obj_alloc(NONE_T);
+	}
+	return obj_char(obj_as_char(op1) % obj_as_char(op2));
+}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
 
-	return result;
+static Object *mod_int(Object *op1, Object *op2)
+{
+	if (obj_as_int(op2) == 0) {
+		raise(DivisionByZeroError);
+		return obj_alloc(NONE_T);
+	}
+	return checked(obj_int(obj_as_int(op1) % obj_as_int(op2)));
 }
 
 
-static Object *number_mod(Object *op1, Object *op2)
+static Object *mod_float(Object *op1, Object *op2)
 {
-	Object *result = NULL;
+	UNUSED(op1);
 
 	if (obj_as_float(op2) == 0)
 		raise(DivisionByZeroError);
 	else
-		switch (coerce(op1, op2)) {
-			case CHAR_T:
-				result = obj_create(CHAR_T, obj_as_char(op1) % obj_as_char(op2));
-				break;
-			case INT_T:
-				result = obj_create(INT_T, obj_as_int(op1) % obj_as_int(op2));
-				break;
-			case FLOAT_T:
-				raise(ModNotAllowedError, "%% operator only allowed on integers");
-				break;
-			default:
-				assert(0);
-				break;
-		}
-
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
+		raise(ModNotAllowedError, "%% operator only allowed on integers");
 
-	return result;
+	return obj_alloc(NONE_T);
 }
 
 
-static Object *number_inv(Object *op1)
+/* Logical operators, the result is integer 0 or 1 for every type.
+ */
+static Object *number_or(Object *op1, Object *op2)
 {
-	Object *op2 = NULL, *result;
-
-	switch (TYPE(op1)) {
-		case CHAR_T:
-			op2 = obj_create(CHAR_T, (char_t)0);
-			break;
-		case INT_T:
-			op2 = obj_create(INT_T, (int_t)0);
-			break;
-		case FLOAT_T:
-			op2 = obj_create(FLOAT_T, (float_t)0);
-			break;
-		default:
-			assert(0);
-			break;
-	}
-
-	if (op2) {
-		result = obj_sub(op2, op1);
-		obj_decref(op2);
-	} else  /* op2 == NULL */
-		result = obj_alloc(NONE_T);
-
-	return result;
+	return obj_bool(obj_as_bool(op1) || obj_as_bool(op2));
 }
 
 
-static Object *number_eql(Object *op1, Object *op2)
+static Object *number_and(Object *op1, Object *op2)
 {
-	Object *result;
-
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) == obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) == obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) == obj_as_char(op2)));
+	return obj_bool(obj_as_bool(op1) && obj_as_bool(op2));
+}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
 
-	return result;
-}
+/* Kernels per operator, indexed by the type of the result.
+ */
+static const kernel_t kernels[OBJOPERATORS][3] = {
+	[OBJ_ADD] = { add_char, add_int, add_float },
+	[OBJ_SUB] = { sub_char, sub_int, sub_float },
+	[OBJ_MUL] = { mul_char, mul_int, mul_float },
+	[OBJ_DIV] = { div_char, div_int, div_float },
+	[OBJ_MOD] = { mod_char, mod_int, mod_float },
+	[OBJ_EQL] = { eql_char, eql_int, eql_float },
+	[OBJ_NEQ] = { neq_char, neq_int, neq_float },
+	[OBJ_LSS] = { lss_char, lss_int, lss_float },
+	[OBJ_LEQ] = { leq_char, leq_int, leq_float },
+	[OBJ_GTR] = { gtr_char, gtr_int, gtr_float },
+	[OBJ_GEQ] = { geq_char, geq_int, geq_float },
+	[OBJ_OR] = { number_or, number_or, number_or },
+	[OBJ_AND] = { number_and, number_and, number_and }
+	};
 
 
-static Object *number_neq(Object *op1, Object *op2)
+/* Register the kernels for all combinations of numeric operands.
+ */
+void number_register(void)
 {
-	Object *result;
+	static const objecttype_t number[] = { CHAR_T, INT_T, FLOAT_T };
 
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) != obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) != obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) != obj_as_char(op2)));
-
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++) {
+			objecttype_t result = coerce(number[i], number[j]);
 
-	return result;
+			for (objoperator_t operator = 0; operator < OBJOPERATORS; operator++)
+				obj_register(operator, number[i], number[j], kernels[operator][result - CHAR_T]);
+		}
 }
 
 
-static Object *number_lss(Object *op1, Object *op2)
+/* Calculate op1 = op1 <operator> op2 and store the result in op1 itself,
+ * so no object is created for the result.
+ *
+ * The result is calculated in the type determined by coerce() and then
+ * converted to the type of op1, which is exactly what obj_assign() does
+ * with the result of number_add() etc. Op1 must not be an immediate.
+ *
+ * operator	one of + - * / %
+ */
+static void number_update(Object *op1, char operator, Object *op2)
 {
-	Object *result;
+	objecttype_t type = coerce(TYPE(op1), TYPE(op2));
+	float_t f = 0;
+	int_t i = 0;
 
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) < obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) < obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) < obj_as_char(op2)));
-
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
-
-	return result;
-}
+	assert(isImmediate(op1) == false);
 
+	if ((operator == '/' || operator == '%') && obj_as_float(op2) == 0)
+		raise(DivisionByZeroError);
 
-static Object *number_leq(Object *op1, Object *op2)
-{
-	Object *result;
+	if (type == FLOAT_T) {
+		float_t a = obj_as_float(op1), b = obj_as_float(op2);
 
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) <= obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) <= obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) <= obj_as_char(op2)));
+		switch (operator) {
+			case '+': f = a + b; break;
+			case '-': f = a - b; break;
+			case '*': f = a * b; break;
+			case '/': f = a / b; break;
+			case '%': raise(ModNotAllowedError, "%% operator only allowed on integers"); break;
+		}
+	} else {
+		int_t a, b;
+
+		if (type == INT_T)
+			a = obj_as_int(op1), b = obj_as_int(op2);
+		else  /* CHAR_T */
+			a = obj_as_char(op1), b = obj_as_char(op2);
+
+		switch (operator) {
+			case '+': i = a + b; break;
+			case '-': i = a - b; break;
+			case '*': i = a * b; break;
+			case '/': i = a / b; break;
+			case '%': i = a % b; break;
+		}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
+		if (type == CHAR_T)
+			i = (char_t)i;
+	}
 
-	return result;
+	switch (TYPE(op1)) {
+		case CHAR_T:
+			((CharObject *)op1)->cval = type == FLOAT_T ? (char_t)f : (char_t)i;
+			break;
+		case INT_T:
+			((IntObject *)op1)->ival = type == FLOAT_T ? (int_t)f : i;
+			break;
+		case FLOAT_T:
+			((FloatObject *)op1)->fval = type == FLOAT_T ? f : i;
+			break;
+		default:
+			assert(0);
+			break;
+	}
 }
 
 
-static Object *number_gtr(Object *op1, Object *op2)
+static void number_iadd(Object *op1, Object *op2)
 {
-	Object *result;
-
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) > obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) > obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) > obj_as_char(op2)));
-
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
-
-	return result;
+	number_update(op1, '+', op2);
 }
 
 
-static Object *number_geq(Object *op1, Object *op2)
+static void number_isub(Object *op1, Object *op2)
 {
-	Object *result;
-
-	if (TYPE(op1) == FLOAT_T || TYPE(op2) == FLOAT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_float(op1) >= obj_as_float(op2)));
-	else if (TYPE(op1) == INT_T || TYPE(op1) == INT_T)
-		result = obj_create(INT_T, (int_t)(obj_as_int(op1) >= obj_as_int(op2)));
-	else
-		result = obj_create(INT_T, (int_t)(obj_as_char(op1) >= obj_as_char(op2)));
+	number_update(op1, '-', op2);
+}
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
 
-	return result;
+static void number_imul(Object *op1, Object *op2)
+{
+	number_update(op1, '*', op2);
 }
 
 
-static Object *number_or(Object *op1, Object *op2)
+static void number_idiv(Object *op1, Object *op2)
 {
-	Object *result;
+	number_update(op1, '/', op2);
+}
 
-	result = obj_create(INT_T, (int_t)(obj_as_bool(op1) || obj_as_bool(op2) ? 1 : 0));
 
-	if (result == NULL)
-		result = obj_alloc(NONE_T);
-
-	return result;
+static void number_imod(Object *op1, Object *op2)
+{
+	number_update(op1, '%', op2);
 }
 
 
-static Object *number_and(Object *op1, Object *op2)
+static Object *number_inv(Object *op1)
 {
-	Object *result;
+	Object *op2 = NULL, *result;
 
-	result = obj_create(INT_T, (int_t)(obj_as_bool(op1) && obj_as_bool(op2) ? 1 : 0));
+	switch (TYPE(op1)) {
+		case CHAR_T:
+			op2 = obj_char((char_t)0);
+			break;
+		case INT_T:
+			op2 = obj_int((int_t)0);
+			break;
+		case FLOAT_T:
+			op2 = obj_create(FLOAT_T, (float_t)0);
+			break;
+		default:
+			assert(0);
+			break;
+	}
 
-	if (result == NULL)
+	if (op2) {
+		result = obj_sub(op2, op1);
+		obj_decref(op2);
+	} else  /* op2 == NULL */
 		result = obj_alloc(NONE_T);
 
 	return result;
@@ -463,7 +468,7 @@ static Object *number_negate(Object *op1)
 {
 	Object *result;
 
-	result = obj_create(INT_T, (int_t)!obj_as_bool(op1));
+	result = obj_bool(!obj_as_bool(op1));
 
 	if (result == NULL)
 		result = obj_alloc(NONE_T);
@@ -515,19 +520,11 @@ NumberType numbertype = {
 	.vset = number_vset,
 	.method = number_method,
 
-	.add = number_add,
-	.sub = number_sub,
-	.mul = number_mul,
-	.div = number_div,
-	.mod = number_mod,
+	.iadd = number_iadd,
+	.isub = number_isub,
+	.imul = number_imul,
+	.idiv = number_idiv,
+	.imod = number_imod,
 	.inv = number_inv,
-	.eql = number_eql,
-	.neq = number_neq,
-	.lss = number_lss,
-	.leq = number_leq,
-	.gtr = number_gtr,
-	.geq = number_geq,
-	.or = number_or,
-	.and = number_and,
 	.negate = number_negate
 	};
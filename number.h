@@ -42,23 +42,30 @@ extern FloatType floattype;
 
 typedef struct {
 	TYPE_HEAD;
-	Object *(*add)(Object *op1, Object *op2);
-	Object *(*sub)(Object *op1, Object *op2);
-	Object *(*mul)(Object *op1, Object *op2);
-	Object *(*div)(Object *op1, Object *op2);
-	Object *(*mod)(Object *op1, Object *op2);
+	void (*iadd)(Object *op1, Object *op2);
+	void (*isub)(Object *op1, Object *op2);
+	void (*imul)(Object *op1, Object *op2);
+	void (*idiv)(Object *op1, Object *op2);
+	void (*imod)(Object *op1, Object *op2);
 	Object *(*inv)(Object *op1);
-	Object *(*eql)(Object *op1, Object *op2);
-	Object *(*neq)(Object *op1, Object *op2);
-	Object *(*lss)(Object *op1, Object *op2);
-	Object *(*leq)(Object *op1, Object *op2);
-	Object *(*gtr)(Object *op1, Object *op2);
-	Object *(*geq)(Object *op1, Object *op2);
-	Object *(*or)(Object *op1, Object *op2);
-	Object *(*and)(Object *op1, Object *op2);
 	Object *(*negate)(Object *op1);
 } NumberType;
 
 extern NumberType numbertype;
 
+extern void number_register(void);
+
+
+/* Value of a CHAR_T or INT_T object, which may be an immediate.
+ */
+static inline char_t char_value(Object *obj)
+{
+	return isImmediate(obj) ? (char_t)immediate_value(obj) : ((CharObject *)obj)->cval;
+}
+
+static inline int_t int_value(Object *obj)
+{
+	return isImmediate(obj) ? immediate_value(obj) : ((IntObject *)obj)->ival;
+}
+
 #endif
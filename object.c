@@ -61,9 +61,12 @@
  *  Object *obj_negate(Object *op1)
  *  Object *obj_add(Object *op1, Object *op2)
  *
- * Function arguments operand1 and operand2 always remain unchanged. Result is
- * a newly created object. Its type is dependent on operand1 and optionally
- * operand2. The operations always return a usable result, so never NULL as
+ * Function arguments operand1 and operand2 remain unchanged. Result is a
+ * newly created object. Its type is dependent on operand1 and optionally
+ * operand2. Exceptions are the in place obj_i...() functions, which store
+ * the result in operand1 and return nothing, and the obj_..._tmp() functions,
+ * which may store the result in a temporary operand1 and return that (see
+ * obj_add_tmp()). The operations always return a usable result, so never NULL as
  * this can be a source of bugs. However the results may not be useful as in
  * case of errors often a NONE_T is returned. Exception are obj_alloc() and
  * obj_create() which return a NULL in case the memory allocation failed.
@@ -87,6 +90,10 @@
 #include "none.h"
 #include "list.h"
 #include "str.h"
+#include "cursor.h"
+#include "range.h"
+#include "dict.h"
+#include "numarray.h"
 
 
 #ifdef DEBUG
@@ -108,6 +115,14 @@ static void _dequeue(Object *obj);
 # endif
 
 
+/* Return the type object for an immediate (see object.h).
+ */
+TypeObject *immediate_typeobj(const void *obj)
+{
+	return (uintptr_t)obj & IMMEDIATE_CHAR ? (TypeObject *)&chartype : (TypeObject *)&inttype;
+}
+
+
 /* Create a new object of type 'type' and assign the default initial value.
  *
  * The initial refcount of the new object is 1.
@@ -141,6 +156,21 @@ Object *obj_alloc(objecttype_t type)
 		case NONE_T:
 			obj = nonetype.alloc();
 			break;
+		case CURSOR_T:
+			obj = cursortype.alloc();
+			break;
+		case RANGE_T:
+			obj = rangetype.alloc();
+			break;
+		case DICT_T:
+			obj = dicttype.alloc();
+			break;
+		case SET_T:
+			obj = settype.alloc();
+			break;
+		case NUMARRAY_T:
+			obj = numarraytype.alloc();
+			break;
 	}
 
 	debug_printf(DEBUGALLOC, "\nalloc : %-p", (void *)obj);
@@ -256,11 +286,16 @@ Object *obj_scan(FILE *fp, objecttype_t type)
 
 
 /* (type op1)result = op1
+ *
+ * Strings and lists share their content with the copy until one of them
+ * is modified (copy on write), so copying them takes constant time.
  *
  * return	object with result or none-object in case of error
  */
 Object *obj_copy(Object *op1)
 {
+	Object *obj;
+
 	switch (TYPE(op1)) {
 		case CHAR_T:
 			return obj_create(CHAR_T, obj_as_char(op1));
@@ -269,11 +304,20 @@ Object *obj_copy(Object *op1)
 		case FLOAT_T:
 			return obj_create(FLOAT_T, obj_as_float(op1));
 		case STR_T:
-			return obj_create(STR_T, obj_as_str(op1));
+			obj = obj_alloc(STR_T);
+			strtype.share((StrObject *)obj, (StrObject *)op1);
+			return obj;
 		case LIST_T:
 			return obj_create(LIST_T, obj_as_list(op1));
-		case LISTNODE_T:
-			return obj_copy(obj_from_listnode(op1));
+		case DICT_T:
+			return obj_create(DICT_T, op1);
+		case SET_T:
+			return obj_create(SET_T, op1);
+		case NUMARRAY_T:
+			return obj_create(NUMARRAY_T, op1);
+		case RANGE_T:  /* a range cannot be modified so it can be shared */
+			obj_incref(op1);
+			return op1;
 		default:
 			raise(TypeError, "cannot copy type %s", TYPENAME(op1));
 			return obj_alloc(NONE_T);
@@ -301,11 +345,21 @@ void obj_assign(Object *op1, Object *op2)
 			break;
 		case STR_T:
 			obj = obj_to_strobj(op2);
-			TYPEOBJ(op1)->set(op1, obj_as_str(obj));
+			strtype.share((StrObject *)op1, (StrObject *)obj);
 			obj_decref(obj);
 			break;
 		case LIST_T:
-			TYPEOBJ(op1)->set(op1, obj_as_list(op2));
+			if (TYPE(op2) == RANGE_T)  /* a range is expanded into a list */
+				TYPEOBJ(op1)->set(op1, op2);
+			else
+				TYPEOBJ(op1)->set(op1, obj_as_list(op2));
+			break;
+		case DICT_T:
+			TYPEOBJ(op1)->set(op1, obj_as_dict(op2));
+			break;
+		case SET_T:  /* a set can be built from any sequence */
+		case NUMARRAY_T:
+			TYPEOBJ(op1)->set(op1, op2);
 			break;
 		case LISTNODE_T:
 			TYPEOBJ(op1)->set(op1, obj_copy(op2));
@@ -317,26 +371,66 @@ void obj_assign(Object *op1, Object *op2)
 }
 
 
+/* Text of the operators for error messages.
+ */
+static const char *operatorname[OBJOPERATORS] = {
+	[OBJ_ADD] = "+", [OBJ_SUB] = "-", [OBJ_MUL] = "*", [OBJ_DIV] = "/", [OBJ_MOD] = "%",
+	[OBJ_EQL] = "==", [OBJ_NEQ] = "!=", [OBJ_LSS] = "<", [OBJ_LEQ] = "<=",
+	[OBJ_GTR] = ">", [OBJ_GEQ] = ">=", [OBJ_OR] = "or", [OBJ_AND] = "and"
+	};
+
+kernel_t dispatch[OBJOPERATORS][MAXTYPES][MAXTYPES];
+
+
+/* Store the kernel for operator 'operator' on operands of type 'type1'
+ * and 'type2' in the dispatch matrix.
+ */
+void obj_register(objoperator_t operator, objecttype_t type1, objecttype_t type2, kernel_t kernel)
+{
+	assert(type1 < MAXTYPES && type2 < MAXTYPES);
+
+	dispatch[operator][type1][type2] = kernel;
+}
+
+
+/* Let every type module register the kernels for its binary operators.
+ * Must be called before the first operation on objects.
+ */
+void obj_init(void)
+{
+	number_register();
+	str_register();
+	list_register();
+	dict_register();
+	numarray_register();
+}
+
+
+/* Execute an operator for which the dispatch matrix has no kernel.
+ *
+ * Operands of types which cannot be combined are by definition not
+ * equal, for all other operators this is an error.
+ *
+ * return	object with result or none-object in case of error
+ */
+Object *obj_dispatch_other(objoperator_t operator, Object *op1, Object *op2)
+{
+	if (operator == OBJ_EQL || operator == OBJ_NEQ)
+		return obj_bool(operator == OBJ_NEQ);
+
+	raise(TypeError, "unsupported operand type(s) for operation %s: %s and %s", \
+					  operatorname[operator], TYPENAME(op1), TYPENAME(op2));
+	return obj_alloc(NONE_T);
+}
+
+
 /* result = op1 + op2
  *
  * return	object with result or none-object in case of error
  */
 Object *obj_add(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.add(op1, op2);
-	else if (isString(op1) || isString(op2))
-		return strtype.concat(op1, op2);
-	else if (isList(op1) && isList(op2))
-		return listtype.concat((ListObject *)op1, (ListObject *)op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation +: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_ADD, op1, op2);
 }
 
 
@@ -346,16 +440,7 @@ Object *obj_add(Object *op1, Object *op2)
  */
 Object *obj_sub(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.sub(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation -: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_SUB, op1, op2);
 }
 
 
@@ -365,20 +450,7 @@ Object *obj_sub(Object *op1, Object *op2)
  */
 Object *obj_mult(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.mul(op1, op2);
-	else if ((isNumber(op1) || isNumber(op2)) && (isString(op1) || isString(op2)))
-		return strtype.repeat(op1, op2);
-	else if ((isNumber(op1) || isNumber(op2)) && (isList(op1) || isList(op2)))
-		return listtype.repeat(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation *: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_MUL, op1, op2);
 }
 
 
@@ -388,16 +460,7 @@ Object *obj_mult(Object *op1, Object *op2)
  */
 Object *obj_divs(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.div(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation /: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_DIV, op1, op2);
 }
 
 
@@ -407,27 +470,215 @@ Object *obj_divs(Object *op1, Object *op2)
  */
 Object *obj_mod(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
+	return obj_dispatch(OBJ_MOD, op1, op2);
+}
+
+
+/* Check if op1 is an array and op2 an array or a number, so the operation
+ * is done by the array kernels (see numarray.c).
+ */
+static bool elementwise(Object *op1, Object *op2)
+{
+	return TYPE(op1) == NUMARRAY_T && (isNumber(op2) || TYPE(op2) == NUMARRAY_T);
+}
+
+
+/* In-place versions of the arithmetic operators for the compound
+ * assignments. The target op1 is modified, so no new object is created for
+ * the result. Strings and lists are extended in their spare capacity,
+ * arrays are calculated in their own values. Combinations which cannot be
+ * done in place (like a listnode as target) calculate a new value and
+ * assign it to op1, which has the same effect.
+ * Op1 must not be an immediate or a constant.
+ */
+static void update(Object *op1, Object *(*operation)(Object *, Object *), Object *op2)
+{
+	Object *result, *element;
 
+	if (isListNode(op1)) {  /* calculate with the element the listnode refers to */
+		element = obj_from_listnode(op1);
+		result = operation(element, op2);
+		obj_decref(element);
+	} else
+		result = operation(op1, op2);
+
+	obj_assign(op1, result);
+	obj_decref(result);
+}
+
+
+/* op1 += op2
+ */
+void obj_iadd(Object *op1, Object *op2)
+{
 	if (isNumber(op1) && isNumber(op2))
-		return numbertype.mod(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation %%: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
+		numbertype.iadd(op1, op2);
+	else if (isString(op1))
+		strtype.iconcat((StrObject *)op1, op2);
+	else if (isList(op1) && isList(op2))
+		listtype.iconcat((ListObject *)op1, (ListObject *)op2);
+	else if (elementwise(op1, op2))
+		numarraytype.iadd((NumArrayObject *)op1, op2);
+	else
+		update(op1, obj_add, op2);
+}
+
+
+/* op1 -= op2
+ */
+void obj_isub(Object *op1, Object *op2)
+{
+	if (isNumber(op1) && isNumber(op2))
+		numbertype.isub(op1, op2);
+	else if (elementwise(op1, op2))
+		numarraytype.isub((NumArrayObject *)op1, op2);
+	else
+		update(op1, obj_sub, op2);
+}
+
+
+/* op1 *= op2
+ */
+void obj_imult(Object *op1, Object *op2)
+{
+	if (isNumber(op1) && isNumber(op2))
+		numbertype.imul(op1, op2);
+	else if (isString(op1) && isNumber(op2))
+		strtype.irepeat((StrObject *)op1, op2);
+	else if (isList(op1) && isNumber(op2))
+		listtype.irepeat((ListObject *)op1, op2);
+	else if (elementwise(op1, op2))
+		numarraytype.imul((NumArrayObject *)op1, op2);
+	else
+		update(op1, obj_mult, op2);
+}
+
+
+/* op1 /= op2
+ */
+void obj_idivs(Object *op1, Object *op2)
+{
+	if (isNumber(op1) && isNumber(op2))
+		numbertype.idiv(op1, op2);
+	else if (elementwise(op1, op2))
+		numarraytype.idiv((NumArrayObject *)op1, op2);
+	else
+		update(op1, obj_divs, op2);
+}
+
+
+/* op1 %= op2
+ */
+void obj_imod(Object *op1, Object *op2)
+{
+	if (isNumber(op1) && isNumber(op2))
+		numbertype.imod(op1, op2);
+	else
+		update(op1, obj_mod, op2);
+}
+
+
+/* Check if the result of an arithmetic operation on numbers op1 and op2
+ * has the type of op1. For an array the kind of its values must remain
+ * the same: an integer array stays integer unless op2 is or holds floats.
+ */
+static bool numeric(Object *op1, Object *op2)
+{
+	switch (TYPE(op1)) {
+		case FLOAT_T:
+			return isNumber(op2);
+		case INT_T:
+			return TYPE(op2) == INT_T || TYPE(op2) == CHAR_T;
+		case CHAR_T:
+			return TYPE(op2) == CHAR_T;
+		case NUMARRAY_T:
+			return elementwise(op1, op2) && (((NumArrayObject *)op1)->kind == FLOAT_T || \
+					(TYPE(op2) == NUMARRAY_T ? ((NumArrayObject *)op2)->kind == INT_T : TYPE(op2) != FLOAT_T));
+		default:
+			return false;
 	}
 }
 
 
+static Object *reuse(Object *op1, void (*operation)(Object *, Object *), Object *op2)
+{
+	operation(op1, op2);
+	obj_incref(op1);
+
+	return op1;
+}
+
+
+/* result = op1 + op2, op1 is a temporary
+ *
+ * Intermediate results, like a + b in a + b + c, are released by the caller
+ * right after they have been used as operand. If nobody else refers to the
+ * left operand (its refcount is 1) the ..._tmp() variants store the result
+ * in the left operand itself via the obj_i...() functions, instead of
+ * creating a new object. As the caller still releases the left operand its
+ * refcount is incremented, so it survives as the result. This is only done
+ * if the in place operation gives the same result as the regular one, so
+ * the type of the left operand must be the type of the result.
+ */
+Object *obj_add_tmp(Object *op1, Object *op2)
+{
+	if (isTemporary(op1) && (numeric(op1, op2) || isString(op1) || (isList(op1) && isList(op2))))
+		return reuse(op1, obj_iadd, op2);
+
+	return obj_add(op1, op2);
+}
+
+
+/* result = op1 - op2, op1 is a temporary
+ */
+Object *obj_sub_tmp(Object *op1, Object *op2)
+{
+	if (isTemporary(op1) && numeric(op1, op2))
+		return reuse(op1, obj_isub, op2);
+
+	return obj_sub(op1, op2);
+}
+
+
+/* result = op1 * op2, op1 is a temporary
+ */
+Object *obj_mult_tmp(Object *op1, Object *op2)
+{
+	if (isTemporary(op1) && (numeric(op1, op2) || ((isString(op1) || isList(op1)) && isNumber(op2))))
+		return reuse(op1, obj_imult, op2);
+
+	return obj_mult(op1, op2);
+}
+
+
+/* result = op1 / op2, op1 is a temporary
+ */
+Object *obj_divs_tmp(Object *op1, Object *op2)
+{
+	if (isTemporary(op1) && numeric(op1, op2))
+		return reuse(op1, obj_idivs, op2);
+
+	return obj_divs(op1, op2);
+}
+
+
+/* result = op1 % op2, op1 is a temporary
+ */
+Object *obj_mod_tmp(Object *op1, Object *op2)
+{
+	if (isTemporary(op1) && numeric(op1, op2))
+		return reuse(op1, obj_imod, op2);
+
+	return obj_mod(op1, op2);
+}
+
+
 /* result = 0 - op1
  *
  * return	object with result or none-object in case of error
  */
 Object *obj_invert(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	if (isNumber(op1))
 		return numbertype.inv(op1);
 	else {
@@ -444,18 +695,7 @@ Object *obj_invert(Object *op1)
  */
 Object *obj_eql(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.eql(op1, op2);
-	else if (isString(op1) && isString(op2))
-		return strtype.eql(op1, op2);
-	else if (isList(op1) && isList(op2))
-		return listtype.eql((ListObject *)op1, (ListObject *)op2);
-	else
-		/* operands of different types are by definition not equal */
-		return obj_create(INT_T, (int_t)0);
+	return obj_dispatch(OBJ_EQL, op1, op2);
 }
 
 
@@ -465,18 +705,7 @@ Object *obj_eql(Object *op1, Object *op2)
  */
 Object *obj_neq(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.neq(op1, op2);
-	else if (isString(op1) && isString(op2))
-		return strtype.neq(op1, op2);
-	else if (isList(op1) && isList(op2))
-		return listtype.neq((ListObject *)op1, (ListObject *)op2);
-	else
-		/* operands of different types are by definition not equal */
-		return obj_create(INT_T, (int_t)1);
+	return obj_dispatch(OBJ_NEQ, op1, op2);
 }
 
 
@@ -486,16 +715,7 @@ Object *obj_neq(Object *op1, Object *op2)
  */
 Object *obj_lss(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.lss(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation <: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_LSS, op1, op2);
 }
 
 
@@ -505,16 +725,7 @@ Object *obj_lss(Object *op1, Object *op2)
  */
 Object *obj_leq(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.leq(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation <=: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_LEQ, op1, op2);
 }
 
 
@@ -524,16 +735,7 @@ Object *obj_leq(Object *op1, Object *op2)
  */
 Object *obj_gtr(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.gtr(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation >: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_GTR, op1, op2);
 }
 
 
@@ -543,16 +745,7 @@ Object *obj_gtr(Object *op1, Object *op2)
  */
 Object *obj_geq(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.geq(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation >=: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_GEQ, op1, op2);
 }
 
 
@@ -562,16 +755,7 @@ Object *obj_geq(Object *op1, Object *op2)
  */
 Object *obj_or(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.or(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation or: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_OR, op1, op2);
 }
 
 
@@ -581,31 +765,34 @@ Object *obj_or(Object *op1, Object *op2)
  */
 Object *obj_and(Object *op1, Object *op2)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
-
-	if (isNumber(op1) && isNumber(op2))
-		return numbertype.and(op1, op2);
-	else {
-		raise(TypeError, "unsupported operand type(s) for operation and: %s and %s", \
-						  TYPENAME(op1), TYPENAME(op2));
-		return obj_alloc(NONE_T);
-	}
+	return obj_dispatch(OBJ_AND, op1, op2);
 }
 
 
 /* result = (int_t)(op1 in (sequence)op2)
+ * result = (int_t)(op1 in (dict)op2), true if op1 is a key
+ * result = (int_t)(op1 in (set)op2)
+ * result = (int_t)(op1 in (range)op2), without visiting the integers
  *
  * return	object with result or none-object in case of error
  */
 Object *obj_in(Object *op1, Object *op2)
 {
-	Object *result = NULL;
+	Object *result = obj_bool(false);  /* also the result for an empty sequence */
 	Object *item;
 	int_t len;
 
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-	op2 = isListNode(op2) ? obj_from_listnode(op2) : op2;
+	if (TYPE(op2) == DICT_T)
+		return obj_bool(dicttype.contains((DictObject *)op2, op1));
+
+	if (TYPE(op2) == SET_T)
+		return obj_bool(settype.contains((SetObject *)op2, op1));
+
+	if (TYPE(op2) == NUMARRAY_T)
+		return obj_bool(numarraytype.contains((NumArrayObject *)op2, op1));
+
+	if (TYPE(op2) == RANGE_T)
+		return obj_bool(rangetype.contains((RangeObject *)op2, op1));
 
 	if (isSequence(op2) == 0) {
 		raise(TypeError, "%s is not subscriptable", TYPENAME(op2));
@@ -614,8 +801,7 @@ Object *obj_in(Object *op1, Object *op2)
 	len = obj_length(op2);
 
 	for (int_t i = 0; i < len; i++) {
-		if (result != NULL)
-			obj_decref(result);
+		obj_decref(result);
 		item = obj_item(op2, i);
 		result = obj_eql(op1, item);
 		obj_decref(item);
@@ -632,8 +818,6 @@ Object *obj_in(Object *op1, Object *op2)
  */
 Object *obj_negate(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	if (isNumber(op1))
 		return numbertype.negate(op1);
 	else {
@@ -645,17 +829,18 @@ Object *obj_negate(Object *op1)
 
 /* item = list[index]
  * item = string[index]
+ * item = array[index]
  *
  * return	object with item or none-object in case of error
  */
 Object *obj_item(Object *sequence, int_t index)
 {
-	sequence = isListNode(sequence) ? obj_from_listnode(sequence) : sequence;
-
 	if (TYPE(sequence) == STR_T)
-		return (Object *)strtype.item((StrObject *)sequence, index);
+		return strtype.item((StrObject *)sequence, index);
 	else if (TYPE(sequence) == LIST_T)
 		return (Object *)listtype.item((ListObject *)sequence, index);
+	else if (TYPE(sequence) == NUMARRAY_T)
+		return numarraytype.item((NumArrayObject *)sequence, index);
 	else {
 		raise(TypeError, "type %s is not subscriptable", TYPENAME(sequence));
 		return obj_alloc(NONE_T);
@@ -663,19 +848,141 @@ Object *obj_item(Object *sequence, int_t index)
 }
 
 
+/* item = list[index]
+ * item = string[index]
+ * item = array[index]
+ * value = dict[key]
+ *
+ * return	object with item or none-object in case of error
+ */
+Object *obj_subscript(Object *container, Object *index)
+{
+	if (TYPE(container) == DICT_T)
+		return dicttype.item((DictObject *)container, index);
+
+	return obj_item(container, obj_as_int(index));
+}
+
+
+/* Create a cursor to iterate over a sequence (STR_T, LIST_T, RANGE_T, DICT_T or SET_T).
+ *
+ * return	cursor-object or none-object in case of error
+ */
+Object *obj_iterate(Object *sequence)
+{
+	Object *cursor;
+
+	if (TYPEOBJ(sequence)->begin == NULL) {
+		raise(TypeError, "type %s is not subscriptable", TYPENAME(sequence));
+		return obj_alloc(NONE_T);
+	}
+
+	if ((cursor = obj_create(CURSOR_T, sequence)) == NULL)
+		return obj_alloc(NONE_T);
+
+	return cursor;
+}
+
+
+/* variable = next item of a sequence
+ *
+ * Used by for-in loops which bind the item to the loop variable. Via this
+ * variable a list can be modified, so for a list the item is a listnode
+ * which refers to the element.
+ *
+ * return	object with item or NULL if there are no items left
+ */
+Object *obj_next(Object *cursor)
+{
+	CursorObject *c = (CursorObject *)cursor;
+
+	return TYPEOBJ(c->sequence)->next(c);
+}
+
+
+/* list[index] = value
+ * dict[key] = value
+ * array[index] = value
+ *
+ * Strings are read-only, so for a string nothing is stored.
+ *
+ * return	object which was stored or none-object in case of error
+ */
+Object *obj_store_item(Object *container, Object *index, Object *value)
+{
+	Object *obj, *result;
+
+	if (TYPE(container) == DICT_T) {
+		obj = obj_copy(value);
+		obj_incref(obj);
+		dicttype.store((DictObject *)container, index, obj);
+		return obj;
+	}
+
+	if (TYPE(container) == LIST_T) {
+		listtype.store((ListObject *)container, obj_as_int(index), obj_copy(value));
+		return listtype.item((ListObject *)container, obj_as_int(index));
+	}
+
+	if (TYPE(container) == NUMARRAY_T) {
+		numarraytype.store((NumArrayObject *)container, obj_as_int(index), value);
+		return numarraytype.item((NumArrayObject *)container, obj_as_int(index));
+	}
+
+	obj = obj_item(container, obj_as_int(index));
+	result = obj_copy(obj);
+	obj_assign(result, value);
+	obj_decref(obj);
+
+	return result;
+}
+
+
+/* list[index] = list[index] (operation) value
+ * dict[key] = dict[key] (operation) value
+ * array[index] = array[index] (operation) value
+ *
+ * Operation is one of the obj_..._tmp() functions, so an element which is
+ * only held by the list or dict is modified in place. Strings are
+ * read-only, so for a string nothing is stored.
+ *
+ * return	object which was stored or none-object in case of error
+ */
+Object *obj_update_item(Object *container, Object *index, Object *(*operation)(Object *, Object *), Object *value)
+{
+	Object *obj, *result;
+
+	if (TYPE(container) == DICT_T)
+		return dicttype.update((DictObject *)container, index, operation, value);
+
+	if (TYPE(container) == LIST_T)
+		return listtype.update((ListObject *)container, obj_as_int(index), operation, value);
+
+	if (TYPE(container) == NUMARRAY_T)
+		return numarraytype.update((NumArrayObject *)container, obj_as_int(index), operation, value);
+
+	obj = obj_item(container, obj_as_int(index));
+	result = operation(obj, value);
+	obj_decref(obj);
+
+	return result;
+}
+
+
 /* slice = list[start:end]
  * slice = string[start:end]
+ * slice = array[start:end]
  *
  * return	object with slice or none-object in case of error
  */
 Object *obj_slice(Object *sequence, int_t start, int_t end)
 {
-	sequence = isListNode(sequence) ? obj_from_listnode(sequence) : sequence;
-
 	if (TYPE(sequence) == STR_T)
 		return (Object *)strtype.slice((StrObject *)sequence, start, end);
 	else if (TYPE(sequence) == LIST_T)
 		return (Object *)listtype.slice((ListObject *)sequence, start, end);
+	else if (TYPE(sequence) == NUMARRAY_T)
+		return (Object *)numarraytype.slice((NumArrayObject *)sequence, start, end);
 	else {
 		raise(TypeError, "type %s is not subscriptable", TYPENAME(sequence));
 		return obj_alloc(NONE_T);
@@ -693,12 +1000,16 @@ int_t obj_length(Object *sequence)
 	int_t len = 0;
 	Object *obj = NULL;
 
-	sequence = isListNode(sequence) ? obj_from_listnode(sequence) : sequence;
-
 	if (TYPE(sequence) == STR_T)
 		obj = strtype.length((StrObject *)sequence);
 	else if (TYPE(sequence) == LIST_T)
 		obj = listtype.length((ListObject *)sequence);
+	else if (TYPE(sequence) == DICT_T)
+		obj = dicttype.length((DictObject *)sequence);
+	else if (TYPE(sequence) == SET_T)
+		obj = settype.length((SetObject *)sequence);
+	else if (TYPE(sequence) == NUMARRAY_T)
+		obj = numarraytype.length((NumArrayObject *)sequence);
 	else
 		raise(TypeError, "type %s is not subscriptable", TYPENAME(sequence));
 
@@ -743,16 +1054,16 @@ Object *obj_type(Object *op1)
  */
 char_t obj_as_char(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch (TYPE(op1)) {
 		case CHAR_T:
-			return ((CharObject *)op1)->cval;
+			return char_value(op1);
 		case INT_T:
-			return ((IntObject *)op1)->ival;
+			return int_value(op1);
 		case FLOAT_T:
 			return ((FloatObject *)op1)->fval;
 		case STR_T:
+			if (((StrObject *)op1)->length && ((StrObject *)op1)->sptr[0] == '\0')
+				return '\0';  /* an embedded '\0' is not an empty string */
 			return str_to_char(((StrObject *)op1)->sptr);
 		default:
 			raise(ValueError, "cannot convert %s to char", TYPENAME(op1));
@@ -768,13 +1079,11 @@ char_t obj_as_char(Object *op1)
  */
 int_t obj_as_int(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch (TYPE(op1)) {
 		case CHAR_T:
-			return ((CharObject *)op1)->cval;
+			return char_value(op1);
 		case INT_T:
-			return ((IntObject *)op1)->ival;
+			return int_value(op1);
 		case FLOAT_T:
 			return ((FloatObject *)op1)->fval;
 		case STR_T:
@@ -793,13 +1102,11 @@ int_t obj_as_int(Object *op1)
  */
 float_t obj_as_float(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch (TYPE(op1)) {
 		case CHAR_T:
-			return ((CharObject *)op1)->cval;
+			return char_value(op1);
 		case INT_T:
-			return ((IntObject *)op1)->ival;
+			return int_value(op1);
 		case FLOAT_T:
 			return ((FloatObject *)op1)->fval;
 		case STR_T:
@@ -820,8 +1127,6 @@ char *obj_as_str(Object *op1)
 {
 	static char *empty = "";
 
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch (TYPE(op1)) {
 		case STR_T:
 			return ((StrObject *)op1)->sptr;
@@ -841,8 +1146,6 @@ Object *obj_as_list(Object *op1)
 {
 	Object *obj;
 
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch(TYPE(op1)) {
 		case LIST_T:
 			return op1;
@@ -856,6 +1159,28 @@ Object *obj_as_list(Object *op1)
 }
 
 
+/* Return the value of op1 as dict-object
+ *
+ * op1		object who's value to return as dict-object
+ * return	value of op1 as dict-object or an empty dict if op1 cannot be converted to dict-object
+ */
+Object *obj_as_dict(Object *op1)
+{
+	Object *obj;
+
+	switch(TYPE(op1)) {
+		case DICT_T:
+			return op1;
+		default:
+			raise(ValueError, "cannot convert %s to dict", TYPENAME(op1));
+			if ((obj = obj_alloc(DICT_T)) != NULL)
+				return obj;
+			else
+				return obj_alloc(NONE_T);  /* obj_alloc failed because of out of memory */
+	}
+}
+
+
 /* Return the value of op1 as bool
  *
  * op1		object who's value to return as bool
@@ -863,8 +1188,6 @@ Object *obj_as_list(Object *op1)
  */
 bool obj_as_bool(Object *op1)
 {
-	op1 = isListNode(op1) ? obj_from_listnode(op1) : op1;
-
 	switch (TYPE(op1)) {
 		case CHAR_T:
 			return obj_as_char(op1) ? true : false;
@@ -998,8 +1321,8 @@ Object *obj_to_strobj(Object *obj)
 			obj_incref(obj);
 			return obj;
 		case CHAR_T:
-			snprintf(buffer, sizeof(buffer), "%c", obj_as_char(obj));
-			return obj_create(STR_T, buffer);
+			buffer[0] = obj_as_char(obj);
+			return (Object *)strtype.create(buffer, 1);
 		case INT_T:
 			snprintf(buffer, sizeof(buffer), "%ld", obj_as_int(obj));
 			return obj_create(STR_T, buffer);
@@ -22,12 +22,14 @@
 #ifndef _OBJECT_
 #define _OBJECT_
 
+#include <limits.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "array.h"
 #include "config.h"
 
-typedef enum { CHAR_T = 1, INT_T, FLOAT_T, STR_T, LIST_T, LISTNODE_T, NONE_T } objecttype_t;
+typedef enum { CHAR_T = 1, INT_T, FLOAT_T, STR_T, LIST_T, LISTNODE_T, NONE_T, CURSOR_T, RANGE_T, DICT_T, SET_T, NUMARRAY_T } objecttype_t;
 
 #ifdef DEBUG
 	/* The debug version of Object contains nextobj / prevobj pointers
@@ -50,27 +52,110 @@ typedef struct object {
 } Object;
 
 
+struct cursor;  /* see cursor.h */
+
+/* Types which can be iterated over (sequences) set begin() and next().
+ * Begin() prepares a new cursor for iterating over obj, next() returns
+ * the item at the cursor - as it is bound to the variable of a for-in
+ * loop - and advances the cursor, or NULL if there are no items left.
+ * For other types these are NULL.
+ */
 #define TYPE_HEAD	char *name;  \
 					Object *(*alloc)(void);  \
 					void (*free)(Object *obj);  \
 					void (*print)(FILE *fp, Object *obj);  \
 					void (*set)();  /* undefined argument to suppress compiler warnings */  \
 					void (*vset)(Object *obj, va_list argp);  \
-					Object *(*method)(Object *obj, char *name, Array *arguments)
+					Object *(*method)(Object *obj, char *name, Array *arguments);  \
+					void (*begin)(Object *obj, struct cursor *cursor);  \
+					Object *(*next)(struct cursor *cursor)
 
 typedef struct typeobject {
 	TYPE_HEAD;
 } TypeObject;
 
-#define TYPE(obj)		(((Object *)(obj))->type)
-#define TYPEOBJ(obj)	(((Object *)(obj))->typeobj)
-#define TYPENAME(obj)	(((Object *)(obj))->typeobj->name)
+/* Immediate values.
+ *
+ * Integers and characters which are the result of an operation - this
+ * includes the 0 (false) and 1 (true) returned by comparisons - are not
+ * stored in a heap object, but encoded in the object pointer itself.
+ * Heap objects are at least 4 byte aligned, so the two lowest bits of a
+ * real object pointer are always 0. An immediate has bit 0 set, bit 1
+ * tells whether it is a CHAR_T (1) or an INT_T (0), and the other bits
+ * hold the value. Immediates have no reference count and are never freed,
+ * so creating and releasing them does not touch memory.
+ *
+ * Variables are always heap objects, because an assignment modifies the
+ * object of a variable in place. Integers which do not fit in the bits of
+ * an immediate are heap objects as well.
+ */
+#define IMMEDIATE		1
+#define IMMEDIATE_CHAR	2
+#define IMMEDIATE_MAX	(INTPTR_MAX >> 2)
+#define IMMEDIATE_MIN	(-IMMEDIATE_MAX - 1)
+
+#define isImmediate(obj)	(((uintptr_t)(obj) & IMMEDIATE) != 0)
+
+static inline int_t immediate_value(const void *obj)
+{
+	return (int_t)((intptr_t)obj >> 2);
+}
+
+extern TypeObject *immediate_typeobj(const void *obj);
+
+static inline objecttype_t type_of(const void *obj)
+{
+	if (isImmediate(obj))
+		return (uintptr_t)obj & IMMEDIATE_CHAR ? CHAR_T : INT_T;
+
+	return ((Object *)obj)->type;
+}
+
+static inline TypeObject *typeobj_of(const void *obj)
+{
+	return isImmediate(obj) ? immediate_typeobj(obj) : ((Object *)obj)->typeobj;
+}
+
+#define TYPE(obj)		type_of(obj)
+#define TYPEOBJ(obj)	typeobj_of(obj)
+#define TYPENAME(obj)	(typeobj_of(obj)->name)
 
 #define isNumber(obj)	(TYPE(obj) == CHAR_T || TYPE(obj) == INT_T || TYPE(obj) == FLOAT_T)  /* UNSAFE, evaluates obj more then once */
 #define isString(obj)	(TYPE(obj) == STR_T)
 #define isList(obj)		(TYPE(obj) == LIST_T)
 #define isSequence(obj)	(TYPE(obj) == LIST_T || TYPE(obj) == STR_T)  /* UNSAFE, evaluates obj more then once  */
 #define isListNode(obj)	(TYPE(obj) == LISTNODE_T)
+#define isContainer(obj)	(TYPE(obj) == LIST_T || TYPE(obj) == DICT_T || TYPE(obj) == SET_T || TYPE(obj) == NUMARRAY_T)  /* UNSAFE, evaluates obj more then once */
+#define isTemporary(obj)	(isImmediate(obj) == false && ((Object *)(obj))->refcount == 1)  /* nobody else refers to obj */
+
+/* Reference count for objects which must never be released, like the
+ * constants created for literals. It is so high it will not reach 0.
+ */
+#define IMMORTAL		(INT_MAX / 2)
+
+
+/* Dispatch of binary operators.
+ *
+ * For every operator there is a matrix which is indexed by the types of
+ * both operands. An entry points to the function (kernel) which executes
+ * the operator for this combination of types. The type modules fill the
+ * matrix at startup via obj_register(), see obj_init(). An empty entry means
+ * the combination is not supported, which is handled by obj_dispatch_other().
+ * A new type only needs a number below MAXTYPES and its own call to
+ * obj_register().
+ */
+#define MAXTYPES		16
+
+typedef enum { OBJ_ADD, OBJ_SUB, OBJ_MUL, OBJ_DIV, OBJ_MOD, OBJ_EQL, OBJ_NEQ,
+			   OBJ_LSS, OBJ_LEQ, OBJ_GTR, OBJ_GEQ, OBJ_OR, OBJ_AND, OBJOPERATORS } objoperator_t;
+
+typedef Object *(*kernel_t)(Object *op1, Object *op2);
+
+extern kernel_t dispatch[OBJOPERATORS][MAXTYPES][MAXTYPES];
+
+extern void obj_init(void);
+extern void obj_register(objoperator_t operator, objecttype_t type1, objecttype_t type2, kernel_t kernel);
+extern Object *obj_dispatch_other(objoperator_t operator, Object *op1, Object *op2);
 
 
 /* Functions for operations on objects.
@@ -85,17 +170,63 @@ extern Object *obj_scan(FILE *fp, objecttype_t objtype);
 
 static inline void obj_incref(void *obj)
 {
-	((Object *)(obj))->refcount++;
+	if (!isImmediate(obj))
+		((Object *)(obj))->refcount++;
 }
 
 
 static inline void obj_decref(void *obj)
 {
-	if (--((Object *)obj)->refcount <= 0)
+	if (!isImmediate(obj) && --((Object *)obj)->refcount <= 0)
 		obj_free((Object *)obj);
 }
 
 
+/* Return an integer-object for the result of an operation, if possible
+ * as immediate.
+ *
+ * return	integer-object or NULL if out of memory
+ */
+static inline Object *obj_int(int_t i)
+{
+	if (i < IMMEDIATE_MIN || i > IMMEDIATE_MAX)
+		return obj_create(INT_T, i);
+
+	return (Object *)(((uintptr_t)i << 2) | IMMEDIATE);
+}
+
+
+/* Return a char-object for the result of an operation as immediate.
+ */
+static inline Object *obj_char(char_t c)
+{
+	return (Object *)(((uintptr_t)c << 2) | IMMEDIATE_CHAR | IMMEDIATE);
+}
+
+
+/* Return the canonical integer-object for true (1) or false (0).
+ */
+static inline Object *obj_bool(bool b)
+{
+	return obj_int(b ? 1 : 0);
+}
+
+
+/* result = op1 <operator> op2
+ *
+ * return	object with result or none-object in case of error
+ */
+static inline Object *obj_dispatch(objoperator_t operator, Object *op1, Object *op2)
+{
+	kernel_t kernel = dispatch[operator][TYPE(op1)][TYPE(op2)];
+
+	if (kernel)
+		return kernel(op1, op2);
+
+	return obj_dispatch_other(operator, op1, op2);
+}
+
+
 extern void obj_assign(Object *a, Object *b);
 extern Object *obj_copy(Object *a);
 
@@ -104,6 +235,16 @@ extern Object *obj_sub(Object *op1, Object *op2);
 extern Object *obj_mult(Object *op1, Object *op2);
 extern Object *obj_divs(Object *op1, Object *op2);
 extern Object *obj_mod(Object *op1, Object *op2);
+extern void obj_iadd(Object *op1, Object *op2);
+extern void obj_isub(Object *op1, Object *op2);
+extern void obj_imult(Object *op1, Object *op2);
+extern void obj_idivs(Object *op1, Object *op2);
+extern void obj_imod(Object *op1, Object *op2);
+extern Object *obj_add_tmp(Object *op1, Object *op2);
+extern Object *obj_sub_tmp(Object *op1, Object *op2);
+extern Object *obj_mult_tmp(Object *op1, Object *op2);
+extern Object *obj_divs_tmp(Object *op1, Object *op2);
+extern Object *obj_mod_tmp(Object *op1, Object *op2);
 extern Object *obj_eql(Object *op1, Object *op2);
 
 extern Object *obj_neq(Object *op1, Object *op2);
@@ -121,6 +262,11 @@ extern Object *obj_invert(Object *op1);
 
 extern int_t obj_length(Object *sequence);
 extern Object *obj_item(Object *sequence, int_t index);
+extern Object *obj_subscript(Object *container, Object *index);
+extern Object *obj_iterate(Object *sequence);
+extern Object *obj_next(Object *cursor);
+extern Object *obj_store_item(Object *container, Object *index, Object *value);
+extern Object *obj_update_item(Object *container, Object *index, Object *(*operation)(Object *, Object *), Object *value);
 extern Object *obj_slice(Object *sequence, int_t start, int_t end);
 
 extern Object *obj_type(Object *op1);
@@ -133,6 +279,7 @@ extern float_t obj_as_float(Object *op1);
 extern char *obj_as_str(Object *op1);
 extern bool obj_as_bool(Object *a);
 extern Object *obj_as_list(Object *op1);
+extern Object *obj_as_dict(Object *op1);
 
 extern char_t str_to_char(const char *s);
 extern int_t str_to_int(const char *s);
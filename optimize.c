@@ -0,0 +1,563 @@
+/* optimize.c
+ *
+ * Optimization of the abstract syntax tree.
+ *
+ * Optimize() is called after check() and before the tree is executed or
+ * compiled. It rewrites the tree in place. Depending on the optimization
+ * level the following is done:
+ *
+ * level 1: constant folding. Unary and binary expressions whose operands
+ *          are literals are evaluated once and replaced by a literal with
+ *          the result. For example '100 * 1000' becomes '100000', and
+ *          '2 * "\n"' becomes "\n\n".
+ *
+ * level 2: constant propagation. A reference to a variable which is
+ *          declared with a literal initial value and which is never
+ *          assigned another value is replaced by a literal with the value
+ *          of the variable. After this the expression containing the
+ *          reference may be folded as well.
+ *
+ * Folding uses the same obj_...() functions as visit(), so the result
+ * follows the same rules (see coerce() in number.c). Expressions which
+ * would raise an error when executed, like a division by zero, are left
+ * alone. The error must be raised when - and only if - the expression is
+ * actually executed.
+ *
+ * Constant propagation is kept on the safe side. It is only done for
+ * variables which are declared directly in the block of a function (or
+ * at global level), so not within an if, while, do or for statement, and
+ * only for references in that same function. In this case the declaration
+ * is guaranteed to have been executed before the reference.
+ */
+#include <stdlib.h>
+
+#include "optimize.h"
+#include "object.h"
+#include "config.h"
+#include "error.h"
+
+
+/* The declarations of the variables for a single scope level.
+ */
+typedef struct {
+	Node **defvar;	/* defvar[slot] = declaration of the variable in this slot, NULL if none */
+	int size;		/* number of elements in defvar */
+} Level;
+
+static Level *level = NULL;	/* level[depth] = declarations in the active function at this depth */
+static int levels = 0;		/* number of elements in level */
+
+static enum { MARK, FOLD } pass;	/* what to do while walking the tree */
+static int depth;			/* scope depth of the function being walked */
+static int nesting;			/* how deep are we nested in if, while, do or for statements */
+
+
+/* Make sure level[d] exists.
+ */
+static void reserve(int d)
+{
+	if (d >= levels) {
+		if ((level = realloc(level, (d + 1) * sizeof(Level))) == NULL)
+			raise(OutOfMemoryError);
+
+		for (int i = levels; i <= d; i++)
+			level[i] = (Level) { NULL, 0 };
+
+		levels = d + 1;
+	}
+}
+
+
+/* Record that 'defvar' is the declaration of the variable at location 'l'.
+ */
+static void declare(Location l, Node *defvar)
+{
+	reserve(l.depth);
+
+	if (l.slot >= level[l.depth].size) {
+		int size = l.slot + 8;
+
+		if ((level[l.depth].defvar = realloc(level[l.depth].defvar, size * sizeof(Node *))) == NULL)
+			raise(OutOfMemoryError);
+
+		for (int i = level[l.depth].size; i < size; i++)
+			level[l.depth].defvar[i] = NULL;
+
+		level[l.depth].size = size;
+	}
+
+	level[l.depth].defvar[l.slot] = defvar;
+}
+
+
+/* Return the declaration of the variable at location 'l', or NULL if
+ * unknown (e.g. for function arguments).
+ */
+static Node *declaration(Location l)
+{
+	if (l.depth >= levels || l.slot >= level[l.depth].size)
+		return NULL;
+
+	return level[l.depth].defvar[l.slot];
+}
+
+
+/* Record that the variable at location 'l' is assigned a value.
+ */
+static void assigned(Location l)
+{
+	Node *defvar;
+
+	if ((defvar = declaration(l)) != NULL)
+		defvar->defvar.assigned = true;
+}
+
+
+/* Mark the variable in the target of an assignment as assigned.
+ */
+static void mark(Node *target)
+{
+	switch (target->type) {
+		case REFERENCE:
+			assigned(target->reference.location);
+			break;
+		case INDEX:
+			mark(target->index.sequence);
+			break;
+		case SLICE:
+			mark(target->slice.sequence);
+			break;
+		case UNARY:
+			mark(target->unary.operand);
+			break;
+		case COMMA_EXPR:
+			mark(target->comma_expr.expressions->element[target->comma_expr.expressions->size - 1]);
+			break;
+		default:
+			break;
+	}
+}
+
+
+/* Is this node a literal without a method call?
+ */
+static bool is_literal(Node *n)
+{
+	return n->type == LITERAL && n->method.valid == false;
+}
+
+
+/* Replace node n by a literal node with value obj.
+ *
+ * The source position and the method of node n are preserved.
+ */
+static void make_literal(Node *n, Object *obj)
+{
+	Node *literal;
+	Object *str;
+	variabletype_t type;
+
+	switch (TYPE(obj)) {
+		case CHAR_T:
+			type = VT_CHAR;
+			break;
+		case INT_T:
+			type = VT_INT;
+			break;
+		case FLOAT_T:
+			type = VT_FLOAT;
+			break;
+		default:  /* STR_T */
+			type = VT_STR;
+			break;
+	}
+
+	str = obj_to_strobj(obj);
+	literal = create(LITERAL, type, obj_as_str(str));  /* the text is only used by print() */
+	obj_decref(str);
+
+	if (!isImmediate(obj))
+		obj->refcount = IMMORTAL;  /* see check_literal() */
+
+	literal->literal.constant = obj;
+	literal->source = n->source;
+	literal->method = n->method;
+
+	*n = *literal;
+
+	free(literal);
+}
+
+
+/* Can 'operator' be applied to 'left' and 'right' without raising an error?
+ */
+static bool is_foldable(binaryoperator_t operator, Object *left, Object *right)
+{
+	bool numbers = isNumber(left) && isNumber(right);
+
+	switch (operator) {
+		case ADD:
+			return numbers || ((isString(left) || isString(right)) && \
+							   (isString(left) || isNumber(left)) && (isString(right) || isNumber(right)));
+		case MUL:
+			return numbers || (isNumber(left) && isString(right)) || (isString(left) && isNumber(right));
+		case DIV:
+			return numbers && obj_as_float(right) != 0;
+		case MOD:
+			return numbers && TYPE(left) != FLOAT_T && TYPE(right) != FLOAT_T && obj_as_int(right) != 0;
+		case SUB:
+		case LSS:
+		case LEQ:
+		case GTR:
+		case GEQ:
+		case LOGICAL_AND:
+		case LOGICAL_OR:
+			return numbers;
+		case EQ:
+		case NEQ:
+			return true;
+		case OP_IN:
+			return isString(right);
+		default:
+			return false;
+	}
+}
+
+
+static void fold_unary(Node *n)
+{
+	Object *operand;
+
+	if (is_literal(n->unary.operand) == false)
+		return;
+
+	operand = n->unary.operand->literal.constant;
+
+	switch (n->unary.operator) {
+		case UNOT:
+			if (isNumber(operand))
+				make_literal(n, obj_negate(operand));
+			break;
+		case UMINUS:
+			if (isNumber(operand))
+				make_literal(n, obj_invert(operand));
+			break;
+		case UPLUS:
+			if (isNumber(operand)) {
+				obj_incref(operand);
+				make_literal(n, operand);
+			}
+			break;
+	}
+}
+
+
+static void fold_binary(Node *n)
+{
+	Object *left, *right, *result;
+
+	if (is_literal(n->binary.left) == false || is_literal(n->binary.right) == false)
+		return;
+
+	left = n->binary.left->literal.constant;
+	right = n->binary.right->literal.constant;
+
+	if (is_foldable(n->binary.operator, left, right) == false)
+		return;
+
+	switch (n->binary.operator) {
+		case ADD:
+			result = obj_add(left, right);
+			break;
+		case SUB:
+			result = obj_sub(left, right);
+			break;
+		case MUL:
+			result = obj_mult(left, right);
+			break;
+		case DIV:
+			result = obj_divs(left, right);
+			break;
+		case MOD:
+			result = obj_mod(left, right);
+			break;
+		case LSS:
+			result = obj_lss(left, right);
+			break;
+		case LEQ:
+			result = obj_leq(left, right);
+			break;
+		case GTR:
+			result = obj_gtr(left, right);
+			break;
+		case GEQ:
+			result = obj_geq(left, right);
+			break;
+		case EQ:
+			result = obj_eql(left, right);
+			break;
+		case NEQ:
+			result = obj_neq(left, right);
+			break;
+		case OP_IN:
+			result = obj_in(left, right);
+			break;
+		case LOGICAL_AND:
+			result = obj_and(left, right);
+			break;
+		case LOGICAL_OR:
+			result = obj_or(left, right);
+			break;
+		default:
+			return;
+	}
+
+	if (result == NULL)
+		return;  /* nothing to fold, leave it to execution */
+
+	if (TYPE(result) == NONE_T) {
+		obj_decref(result);
+		return;
+	}
+
+	make_literal(n, result);
+}
+
+
+/* Replace a reference to a variable whose value never changes by a literal.
+ */
+static void propagate(Node *n)
+{
+	Node *defvar, *value;
+	Object *obj;
+
+	if (n->reference.location.depth != depth)
+		return;  /* variable of an enclosing function or a global */
+
+	if ((defvar = declaration(n->reference.location)) == NULL || defvar->defvar.assigned)
+		return;
+
+	if ((value = defvar->defvar.initialvalue) == NULL || is_literal(value) == false)
+		return;
+
+	switch (defvar->defvar.type) {  /* the conversion done by visit_defvar() */
+		case VT_CHAR:
+		case VT_INT:
+		case VT_FLOAT:
+			if (isNumber(value->literal.constant) == false)
+				return;
+			obj = obj_alloc(defvar->defvar.type == VT_CHAR ? CHAR_T : defvar->defvar.type == VT_INT ? INT_T : FLOAT_T);
+			break;
+		case VT_STR:
+			obj = obj_alloc(STR_T);
+			break;
+		default:
+			return;
+	}
+
+	if (obj == NULL)
+		raise(OutOfMemoryError);
+
+	obj_assign(obj, value->literal.constant);
+
+	make_literal(n, obj);
+}
+
+
+static void walk(Node *n);
+
+
+static void walk_array(Array *a)
+{
+	for (size_t i = 0; i != a->size; i++)
+		walk(a->element[i]);
+}
+
+
+static void walk_function_declaration(Node *n)
+{
+	int d = n->function_declaration.depth;
+	int tmp_depth = depth;
+	int tmp_nesting = nesting;
+	Level tmp_level;
+
+	reserve(d);
+
+	tmp_level = level[d];  /* save the declarations of a previous function at this depth */
+	level[d] = (Level) { NULL, 0 };
+
+	depth = d;
+	nesting = 0;
+
+	walk(n->function_declaration.block);
+
+	free(level[d].defvar);
+	level[d] = tmp_level;
+
+	depth = tmp_depth;
+	nesting = tmp_nesting;
+}
+
+
+/* Walk the tree in the order the nodes were checked.
+ */
+static void walk(Node *n)
+{
+	switch (n->type) {
+		case LITERAL:
+		case PASS_STMNT:
+		case BREAK_STMNT:
+		case CONTINUE_STMNT:
+			break;
+		case ARGLIST:
+			walk_array(n->arglist.arguments);
+			break;
+		case UNARY:
+			walk(n->unary.operand);
+			if (pass == FOLD)
+				fold_unary(n);
+			break;
+		case BINARY:
+			walk(n->binary.left);
+			walk(n->binary.right);
+			if (pass == FOLD)
+				fold_binary(n);
+			break;
+		case ASSIGNMENT:
+			if (pass == MARK)
+				mark(n->assignment.variable);
+			walk(n->assignment.variable);
+			walk(n->assignment.expression);
+			break;
+		case BLOCK:
+			walk_array(n->block.statements);
+			break;
+		case REFERENCE:
+			if (pass == FOLD && config.optimize >= 2)
+				propagate(n);
+			break;
+		case VARIABLE_DECLARATION:
+			walk_array(n->variable_declaration.defvars);
+			break;
+		case DEF_VAR:
+			if (n->defvar.initialvalue)
+				walk(n->defvar.initialvalue);
+			if (pass == MARK)
+				n->defvar.assigned = false;
+			declare(n->defvar.location, pass == MARK || nesting == 0 ? n : NULL);
+			break;
+		case FUNCTION_DECLARATION:
+			walk_function_declaration(n);
+			break;
+		case COMMA_EXPR:
+			walk_array(n->comma_expr.expressions);
+			break;
+		case IF_STMNT:
+			walk(n->if_stmnt.condition);
+			nesting++;
+			walk(n->if_stmnt.consequent);
+			if (n->if_stmnt.alternative)
+				walk(n->if_stmnt.alternative);
+			nesting--;
+			break;
+		case PRINT_STMNT:
+			walk_array(n->print_stmnt.expressions);
+			break;
+		case RETURN_STMNT:
+			if (n->return_stmnt.value)
+				walk(n->return_stmnt.value);
+			break;
+		case EXPRESSION_STMNT:
+			walk(n->expression_stmnt.expression);
+			break;
+		case WHILE_STMNT:
+			walk(n->loop_stmnt.condition);
+			nesting++;
+			walk(n->loop_stmnt.block);
+			nesting--;
+			break;
+		case DO_STMNT:
+			nesting++;
+			walk(n->loop_stmnt.block);
+			nesting--;
+			walk(n->loop_stmnt.condition);
+			break;
+		case FOR_STMNT:
+			if (pass == MARK)
+				assigned(n->for_stmnt.location);
+			walk(n->for_stmnt.expression);
+			nesting++;
+			walk(n->for_stmnt.block);
+			nesting--;
+			break;
+		case IMPORT_STMNT:
+			walk(n->import_stmnt.code);
+			break;
+		case INPUT_STMNT:
+			if (pass == MARK)
+				for (size_t i = 0; i != n->input_stmnt.identifiers->size; i++)
+					assigned(n->input_stmnt.locations[i]);
+			break;
+		case INDEX:
+			walk(n->index.sequence);
+			walk(n->index.index);
+			break;
+		case SLICE:
+			walk(n->slice.sequence);
+			walk(n->slice.start);
+			walk(n->slice.end);
+			break;
+		case INDEX_STORE:
+		case INDEX_UPDATE:
+			if (pass == MARK)
+				mark(n->index_store.sequence);
+			walk(n->index_store.sequence);
+			walk(n->index_store.index);
+			walk(n->index_store.expression);
+			break;
+		case FUNCTION_CALL:
+			walk_array(n->function_call.arguments);
+			break;
+	}
+
+	if (n->method.valid)
+		walk_array(n->method.arguments);
+}
+
+
+static void reset(void)
+{
+	for (int i = 0; i < levels; i++)
+		free(level[i].defvar);
+
+	free(level);
+
+	level = NULL;
+	levels = 0;
+	depth = 0;
+	nesting = 0;
+}
+
+
+/* API: Optimize the checked abstract syntax tree.
+ *
+ * The optimization level is taken from config.optimize, 0 means
+ * no optimization.
+ *
+ * root		root node of the tree
+ */
+void optimize(Node *root)
+{
+	if (config.optimize < 1)
+		return;
+
+	if (config.optimize >= 2) {
+		pass = MARK;  /* first find all variables which are assigned */
+		walk(root);
+		reset();
+	}
+
+	pass = FOLD;
+	walk(root);
+	reset();
+}
@@ -0,0 +1,12 @@
+/* optimize.h
+ *
+ * Optimization of the abstract syntax tree, see optimize.c.
+ */
+#ifndef _OPTIMIZE_
+#define _OPTIMIZE_
+
+#include "ast.h"
+
+extern void optimize(Node *root);
+
+#endif
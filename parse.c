@@ -384,6 +384,28 @@ static Node *logical_or_expr(void)
 }
 
 
+/* Create the node for an assignment to 'target'.
+ *
+ * An assignment to an element of a sequence (sequence[index] = ...) gets
+ * its own node type. So reading an element can return the element itself,
+ * instead of an object via which it can be assigned.
+ */
+static Node *assignment(assignmentoperator_t operator, Node *target, Node *expression)
+{
+	Node *n;
+
+	if (target->type != INDEX || target->method.valid == true)
+		return create(ASSIGNMENT, operator, target, expression);
+
+	n = create(operator == ASSIGN ? INDEX_STORE : INDEX_UPDATE, operator, \
+			   target->index.sequence, target->index.index, expression);
+
+	free(target);  /* the index node itself is not used anymore */
+
+	return n;
+}
+
+
 /* Encode expressions with operators: =  +=  -=  *=  /=  %=
  *
  * Syntax: logical_or_expr ( ( '=' | '+=' | '-=' | '*=' | '\=' | '%=' ) assignment_expr )*
@@ -397,17 +419,17 @@ static Node *assignment_expr(void)
 
 	while (1) {
 		if (accept(EQUAL))
-			value = create(ASSIGNMENT, ASSIGN, value, assignment_expr());
+			value = assignment(ASSIGN, value, assignment_expr());
 		else if (accept(PLUSEQUAL))
-			value = create(ASSIGNMENT, ADDASSIGN, value, logical_or_expr());
+			value = assignment(ADDASSIGN, value, logical_or_expr());
 		else if (accept(MINUSEQUAL))
-			value = create(ASSIGNMENT, SUBASSIGN, value, logical_or_expr());
+			value = assignment(SUBASSIGN, value, logical_or_expr());
 		else if (accept(STAREQUAL))
-			value = create(ASSIGNMENT, MULASSIGN, value, logical_or_expr());
+			value = assignment(MULASSIGN, value, logical_or_expr());
 		else if (accept(SLASHEQUAL))
-			value = create(ASSIGNMENT, DIVASSIGN, value, logical_or_expr());
+			value = assignment(DIVASSIGN, value, logical_or_expr());
 		else if (accept(PERCENTEQUAL))
-			value = create(ASSIGNMENT, MODASSIGN, value, logical_or_expr());
+			value = assignment(MODASSIGN, value, logical_or_expr());
 		else
 			break;
 	}
@@ -523,11 +545,11 @@ static Node *function_declaration(void)
 
 /* Encode declaration of variable(s) and optionally the initial value(s).
  *
- * vt: variable(s) type - char, int, float, str, list
+ * vt: variable(s) type - char, int, float, str, list, dict, set, array
  *
  * Syntax: type identifier ( '=' assignment_expr )? ( ',' identifier ( '=' assignment_expr )? )* NEWLINE
  *
- * in:	token = first token after DEFCHAR, DEFINT, DEFFLOAT, DEFSTR, DEFLIST
+ * in:	token = first token after DEFCHAR, DEFINT, DEFFLOAT, DEFSTR, DEFLIST, DEFDICT, DEFSET, DEFARRAY
  * out:	token = first token after NEWLINE
  */
 static Node *variable_declaration(variabletype_t vt)
@@ -830,6 +852,12 @@ static Node *statement(void)
 		n = variable_declaration(VT_STR);
 	else if (accept(DEFLIST))
 		n = variable_declaration(VT_LIST);
+	else if (accept(DEFDICT))
+		n = variable_declaration(VT_DICT);
+	else if (accept(DEFSET))
+		n = variable_declaration(VT_SET);
+	else if (accept(DEFARRAY))
+		n = variable_declaration(VT_ARRAY);
 	else if (accept(DEFFUNC))
 		n = function_declaration();
 	else if (accept(IF))
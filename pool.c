@@ -0,0 +1,69 @@
+/* pool.c
+ *
+ * Memory pools for small objects.
+ *
+ * Arithmetic creates and releases a new object for almost every
+ * intermediate result. Getting these from the heap via calloc() and
+ * free() is relatively expensive. Instead small objects are taken from
+ * a pool. There is one pool per size class (multiples of POOLGRANULE
+ * bytes). Every pool keeps a linked list of free blocks. Releasing an
+ * object puts its block back at the front of this list, and the next
+ * allocation of the same size class takes it from there. Only when a
+ * pool is empty a new slab of POOLSLABSIZE bytes is claimed from the
+ * heap and cut into blocks. Slabs are never returned to the heap.
+ */
+#include <stdlib.h>
+
+#include "pool.h"
+
+
+Pool pool[POOLCLASSES] = {
+	{ .size = 1 * POOLGRANULE },
+	{ .size = 2 * POOLGRANULE },
+	{ .size = 3 * POOLGRANULE },
+	{ .size = 4 * POOLGRANULE }
+	};
+
+
+/* Claim a new slab from the heap and add its blocks to the freelist of pool p.
+ *
+ * If no memory is available the freelist is left untouched (so remains empty).
+ */
+void pool_refill(Pool *p)
+{
+	char *slab;
+	size_t count = POOLSLABSIZE / p->size;
+
+	if ((slab = malloc(count * p->size)) == NULL)
+		return;
+
+	p->slabs++;
+
+	/* link the blocks in address order, so consecutive allocations are adjacent */
+	for (size_t i = count; i-- > 0;) {
+		Block *block = (Block *)(slab + i * p->size);
+		block->next = p->freelist;
+		p->freelist = block;
+	}
+}
+
+
+#ifdef DEBUG
+void dump_pools_to_file(FILE *fp)
+{
+	fprintf(fp, "%s;%s;%s;%s\n", "blocksize", "hits", "misses", "slabs");
+
+	for (int i = 0; i < POOLCLASSES; i++)
+		fprintf(fp, "%zu;%lu;%lu;%lu\n", pool[i].size, pool[i].hits, pool[i].misses, pool[i].slabs);
+}
+
+void dump_pools(void)
+{
+	FILE *fp;
+
+	if ((fp = fopen("pool.dsv", "w")) != NULL) {
+		dump_pools_to_file(fp);
+		fclose(fp);
+	}
+}
+#endif  /* DEBUG */
@@ -0,0 +1,94 @@
+/* pool.h
+ *
+ * Memory pools for small objects which are created and released very
+ * frequently, like numbers, strings and listnodes.
+ */
+#ifndef _POOL_
+#define _POOL_
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define POOLGRANULE		16		/* block sizes are a multiple of this number of bytes */
+#define POOLCLASSES		4		/* number of size classes, so the largest block is 64 bytes */
+#define POOLSLABSIZE	16384	/* number of bytes to claim from the heap when a pool is empty */
+
+
+/* A free block. The first bytes of a free block are used to link it to
+ * the next free block in the same pool (an intrusive freelist).
+ */
+typedef struct block {
+	struct block *next;
+} Block;
+
+
+/* A pool for blocks of a single size class.
+ */
+typedef struct pool {
+	size_t size;			/* size of a block in bytes */
+	Block *freelist;		/* first free block, NULL if the pool is empty */
+	unsigned long hits;		/* number of allocations served from the freelist */
+	unsigned long misses;	/* number of allocations which required a new slab */
+	unsigned long slabs;	/* number of slabs claimed from the heap */
+} Pool;
+
+extern Pool pool[POOLCLASSES];
+
+extern void pool_refill(Pool *p);
+
+#ifdef DEBUG
+extern void dump_pools_to_file(FILE *fp);
+extern void dump_pools(void);
+#endif  /* DEBUG */
+
+
+/* Return the pool which serves blocks of 'size' bytes.
+ */
+static inline Pool *pool_class(size_t size)
+{
+	assert(size > 0 && size <= POOLCLASSES * POOLGRANULE);
+
+	return &pool[(size - 1) / POOLGRANULE];
+}
+
+
+/* Get a block of at least 'size' bytes. Just like calloc() the block is
+ * filled with zeros.
+ *
+ * return	pointer to block or NULL if out of memory
+ */
+static inline void *pool_alloc(size_t size)
+{
+	Pool *p = pool_class(size);
+	Block *block;
+
+	if (p->freelist) {
+		p->hits++;
+	} else {
+		p->misses++;
+		pool_refill(p);
+		if (p->freelist == NULL)
+			return NULL;
+	}
+
+	block = p->freelist;
+	p->freelist = block->next;
+
+	return memset(block, 0, size);
+}
+
+
+/* Return a block of 'size' bytes, which was acquired via pool_alloc(),
+ * to its pool.
+ */
+static inline void pool_free(void *ptr, size_t size)
+{
+	Pool *p = pool_class(size);
+	Block *block = ptr;
+
+	block->next = p->freelist;
+	p->freelist = block;
+}
+
+#endif
@@ -0,0 +1,134 @@
+/* range.c
+ *
+ * Range object operations.
+ *
+ * A for-in loop over range(start, stop, step) does not create a list with
+ * all integers. Instead next() calculates the item at the position of the
+ * cursor. When range() appears directly in the for-in statement both
+ * engines skip the cursor and count themselves (see visit_for_stmnt() and
+ * OP_FOR_RANGE).
+ */
+#include "error.h"
+#include "range.h"
+#include "cursor.h"
+#include "pool.h"
+
+
+/* Create a new range, which does not yet contain any items.
+ *
+ * return	new range-object or NULL in case of error
+ */
+static RangeObject *range_alloc(void)
+{
+	RangeObject *obj;
+
+	if ((obj = pool_alloc(sizeof(RangeObject))) != NULL) {
+		obj->typeobj = (TypeObject *)&rangetype;
+		obj->type = RANGE_T;
+		obj->refcount = 0;
+
+		obj->start = 0;
+		obj->stop = 0;
+		obj->step = 1;
+	}
+	return obj;  /* returns NULL if alloc failed */
+}
+
+
+static void range_free(RangeObject *range)
+{
+	*range = (const RangeObject) { 0 };  /* clear the object struct, facilitates debugging */
+
+	pool_free(range, sizeof(RangeObject));
+}
+
+
+static void range_print(FILE *fp, RangeObject *range)
+{
+	fprintf(fp, "range(%ld, %ld, %ld)", (long)range->start, (long)range->stop, (long)range->step);
+}
+
+
+/* Set the bounds of a new range.
+ *
+ * argp		start, stop and step as int_t
+ */
+static void range_vset(RangeObject *range, va_list argp)
+{
+	range->start = va_arg(argp, int_t);
+	range->stop = va_arg(argp, int_t);
+	range->step = va_arg(argp, int_t);
+
+	if (range->step == 0)
+		raise(ValueError, "range() step cannot be zero");
+}
+
+
+static Object *range_method(RangeObject *obj, char *name, Array *arguments)
+{
+	UNUSED(arguments);
+
+	raise(SyntaxError, "objecttype %s has no method %s", TYPENAME(obj), name);
+
+	return obj_alloc(NONE_T);
+}
+
+
+/* Check if a number is one of the integers of a range, without visiting
+ * the integers.
+ */
+static bool range_contains(RangeObject *range, Object *value)
+{
+	int_t i;
+
+	if (isNumber(value) == false)
+		return false;
+
+	if (TYPE(value) == FLOAT_T && obj_as_float(value) != (float_t)obj_as_int(value))
+		return false;  /* a float with a fraction is never in a range */
+
+	i = obj_as_int(value);
+
+	if (range->step > 0 ? (i < range->start || i >= range->stop) : (i > range->start || i <= range->stop))
+		return false;
+
+	return (i - range->start) % range->step == 0;
+}
+
+
+static void range_begin(RangeObject *range, CursorObject *cursor)
+{
+	cursor->index = 0;
+	cursor->end = range_length(range);
+}
+
+
+/* Return the next integer of a range.
+ *
+ * return	new int-object or NULL if there are no integers left
+ */
+static Object *range_next(CursorObject *cursor)
+{
+	RangeObject *range = (RangeObject *)cursor->sequence;
+
+	if (cursor->index >= cursor->end)
+		return NULL;
+
+	return obj_create(INT_T, range->start + cursor->index++ * range->step);
+}
+
+
+/* Range object API.
+ */
+RangeType rangetype = {
+	.name = "range",
+	.alloc = (Object *(*)())range_alloc,
+	.free = (void (*)(Object *))range_free,
+	.print = (void (*)(FILE *, Object *))range_print,
+	.vset = (void (*)(Object *, va_list))range_vset,
+	.method = (Object *(*)(Object *, char *, Array *))range_method,
+	.begin = (void (*)(Object *, struct cursor *))range_begin,
+	.next = range_next,
+
+	.contains = range_contains
+	};
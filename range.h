@@ -0,0 +1,37 @@
+/* range.h
+ *
+ * A range is a lazy sequence of integers, as returned by the builtin
+ * function range(). Its items are calculated when they are needed, so a
+ * range never occupies more memory than its start, stop and step.
+ */
+#ifndef _RANGE_
+#define _RANGE_
+
+#include "object.h"
+
+typedef struct {
+	OBJ_HEAD;
+	int_t start;	/* first item */
+	int_t stop;		/* the items stop just before this value */
+	int_t step;		/* difference between two items, never 0 */
+} RangeObject;
+
+typedef struct {
+	TYPE_HEAD;
+	bool (*contains)(RangeObject *range, Object *value);
+} RangeType;
+
+extern RangeType rangetype;
+
+
+/* Return the number of items in a range.
+ */
+static inline int_t range_length(RangeObject *range)
+{
+	if (range->step > 0)
+		return range->start < range->stop ? (range->stop - range->start - 1) / range->step + 1 : 0;
+	else
+		return range->start > range->stop ? (range->start - range->stop - 1) / -range->step + 1 : 0;
+}
+
+#endif
@@ -33,10 +33,12 @@ static struct {
 	token_t token;
 } keywordTable[] = {  /* Note: keyword strings must be sorted alphabetically */
 	{ "and",		AND },
+	{ "array",		DEFARRAY },
 	{ "break",		BREAK },
 	{ "char",		DEFCHAR },
 	{ "continue",	CONTINUE },
 	{ "def",		DEFFUNC },
+	{ "dict",		DEFDICT },
 	{ "do",			DO },
 	{ "else",		ELSE },
 	{ "float",		DEFFLOAT },
@@ -51,6 +53,7 @@ static struct {
 	{ "pass",		PASS },
 	{ "print",		PRINT },
 	{ "return",		RETURN },
+	{ "set",		DEFSET },
 	{ "str",		DEFSTR },
 	{ "while",		WHILE }
 };
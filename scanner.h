@@ -16,7 +16,8 @@ typedef enum { 	UNKNOWN=0, CHAR, INT, FLOAT, STR, STAR, SLASH,
 				DEFFLOAT, DEFSTR, DEFFUNC, DOT, ENDMARKER, RETURN, PERCENT,
 				AND, OR, PLUSEQUAL, MINUSEQUAL, STAREQUAL, SLASHEQUAL,
 				PERCENTEQUAL, NOT, LSQB, RSQB, NEWLINE, INDENT, DEDENT,
-				PASS, BREAK, CONTINUE, DEFLIST, COLON, IMPORT, FOR, IN } token_t;
+				PASS, BREAK, CONTINUE, DEFLIST, COLON, IMPORT, FOR, IN,
+				DEFDICT, DEFSET, DEFARRAY } token_t;
 
 static inline char *tokenName(token_t t)  /* 'inline' requires at least C99 */
 {
@@ -29,7 +30,7 @@ static inline char *tokenName(token_t t)  /* 'inline' requires at least C99 */
 	"ENDMARKER", "RETURN", "PERCENT", "AND", "OR", "PLUSEQUAL", "MINUSEQUAL",
 	"STAREQUAL", "SLASHEQUAL", "PERCENTEQUAL", "NOT", "LSQB", "RSQB",
 	"NEWLINE", "INDENT", "DEDENT", "PASS", "BREAK", "CONTINUE", "DEFLIST",
-	"COLON", "IMPORT", "FOR", "IN" };
+	"COLON", "IMPORT", "FOR", "IN", "DEFDICT", "DEFSET", "DEFARRAY" };
 
 	if (t < 0 || t > (sizeof(string) / sizeof(string[0]) - 1))
 		t = 0;  /* out of bound values revert to 0 */
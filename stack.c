@@ -2,10 +2,11 @@
  *
  * Functions for creating and using a stack which holds void pointers.
  *
- * Pointers are added on top of the stack by using push(), and removed
- * from the stack via pop(). The stack gets an initial size when created
- * but automatically expands or shrinks dependent on the number of
- * elements it contains.
+ * Pointers are added on top of the stack by using stack_push(), and removed
+ * from the stack via stack_pop(). These are inline functions (see stack.h)
+ * as they are used for every step of an expression evaluation. The stack
+ * is a contiguous array which gets an initial size when created. Only when
+ * it is full its size is doubled.
  *
  * Copyright (c) 2020 K.W.E. de Lange
  */
@@ -13,20 +14,7 @@
 #include <stdlib.h>
 
 #include "stack.h"
-
-
-/* Check if stack is full.
- *
- * A full stack has top equal to the capacity - 1 because
- * top is zero-based.
- *
- */
-static bool is_full(Stack *stack)
-{
-	assert(stack != NULL);
-
-	return stack->top == stack->capacity - 1 ? true : false;
-}
+#include "error.h"
 
 
 /* Check if stack is empty.
@@ -42,60 +30,21 @@ static bool is_empty(Stack *stack)
 }
 
 
-/* Add an item to the top of the stack. Increase top by 1.
- *
- */
-void push(Stack *stack, void *item)
-{
-	assert(stack != NULL);
-
-	if (is_full(stack)) {  /* stack overflow so expand the stack */
-		stack->capacity += STACKINCREMENT;
-		stack->array = realloc(stack->array, stack->capacity * sizeof(void *));
-	}
-	stack->array[++stack->top] = item;
-}
-
-
-/* Remove the item at the top of the stack. Decrease top by 1.
- *
- * Shrink the stack of the unused space is more then STACKDECREMENT
- * elements. If shrinking fails then the stack remains unchanged.
+/* Double the size of a full stack.
  *
- * return	item at top of stack or NULL in case of empty stack
+ * The stack never shrinks, so after a while the stack is large enough for
+ * the deepest expression and stack_push() does not need the heap anymore.
  */
-void *pop(Stack *stack)
+void stack_grow(Stack *stack)
 {
 	assert(stack != NULL);
 
-	void *p, *mem;
-
-	if (is_empty(stack))  /* stack underflow */
-		return NULL;
-
-	p = stack->array[stack->top--];
-
-	if (stack->top + 1 - stack->capacity >= STACKDECREMENT)
-		/* reclaim unused stack space */
-		if ((mem = realloc(stack->array, stack->top + 1)) != NULL)
-			stack->array = mem;
-
-	return p;
-}
-
-
-/* Return the item at the top of the stack without removing it.
- *
- * return	item at top of stack or NULL in case of empty stack
- */
-void *peek(Stack *stack)
-{
-	assert(stack != NULL);
+	long capacity = stack->capacity ? stack->capacity * 2 : STACKSIZE;
 
-	if (is_empty(stack))  /* stack underflow */
-		return NULL;
+	if ((stack->array = realloc(stack->array, capacity * sizeof(void *))) == NULL)
+		raise(OutOfMemoryError);
 
-	return stack->array[stack->top];
+	stack->capacity = capacity;
 }
 
 
@@ -114,6 +63,7 @@ Stack *stack_alloc(long capacity)
 	if ((stack = (Stack *)malloc(sizeof(Stack))) != NULL) {
 		stack->capacity = capacity < 0 ? 0 : capacity;  /* minimum stack size is 0 */
 		stack->top = -1;  /* -1 indicates an empty stack */
+		stack->highwater = 0;
 
 		/* allocate the array which will contain the pointers */
 		if ((stack->array = calloc(stack->capacity, sizeof(void *))) == NULL) {
@@ -147,11 +97,9 @@ void stack_free(Stack *stack)
 Stack stack = {
 	.top = -1,
 	.capacity = 0L,
+	.highwater = 0L,
 	.array = NULL,
 	.alloc = stack_alloc,
 	.free = stack_free,
-	.push = push,
-	.pop = pop,
-	.peek = peek,
 	.is_empty = is_empty
 };
@@ -9,22 +9,63 @@
 
 #include <stdbool.h>
 
-#define STACKINCREMENT 10	/* number of elements to add when the stack needs to grow */
-#define STACKDECREMENT 10	/* when stack has this many unused elements it will shrink */
+#define STACKSIZE 256	/* default initial size of a stack as number of elements */
 
 typedef struct stack {
 	long top;				/* zero-based index of the item on top of the stack */
 	long capacity;			/* size of the stack as number of elements */
+	long highwater;			/* maximum number of elements the stack has held */
 	void **array;			/* pointer to an array of pointers holding the values */
 
 	struct stack *(*alloc)(long);
 	void (*free)(struct stack *);
-	void (*push)(struct stack *, void *);
-	void *(*pop)(struct stack *);
-	void *(*peek)(struct stack *);
 	bool (*is_empty)(struct stack *);
 } Stack;
 
 extern Stack stack;
 
+extern void stack_grow(Stack *stack);
+
+
+/* Add an item to the top of the stack. Increase top by 1.
+ *
+ * Only if the stack is full memory is claimed, by doubling its size.
+ */
+static inline void stack_push(Stack *stack, void *item)
+{
+	if (stack->top == stack->capacity - 1)  /* stack overflow so expand the stack */
+		stack_grow(stack);
+
+	stack->array[++stack->top] = item;
+
+	if (stack->top >= stack->highwater)
+		stack->highwater = stack->top + 1;
+}
+
+
+/* Remove the item at the top of the stack. Decrease top by 1.
+ *
+ * return	item at top of stack or NULL in case of empty stack
+ */
+static inline void *stack_pop(Stack *stack)
+{
+	if (stack->top == -1)  /* stack underflow */
+		return NULL;
+
+	return stack->array[stack->top--];
+}
+
+
+/* Return the item at the top of the stack without removing it.
+ *
+ * return	item at top of stack or NULL in case of empty stack
+ */
+static inline void *stack_peek(Stack *stack)
+{
+	if (stack->top == -1)  /* stack underflow */
+		return NULL;
+
+	return stack->array[stack->top];
+}
+
 #endif
@@ -9,15 +9,67 @@
  * Any deviation from these rules is explicitly stated at the
  * respective function.
  *
+ * The length of the string is stored in the object, so no function needs
+ * strlen(). Strings which fit in STRINLINE bytes (including the closing
+ * '\0') are kept inside the object, so creating a short string requires
+ * just a single allocation from a pool. Longer strings are moved to the
+ * heap.
+ *
+ * A string on the heap can be shared by several string-objects (copy on
+ * write). Copying or assigning such a string only increments the
+ * reference count of the heap block, which precedes the characters.
+ * Every function which modifies a string first calls reserve(), which
+ * gives the string-object a private copy if the heap block is shared.
+ * The heap block also caches the hash value of the string, which is used
+ * when the string is a key in a dict (see dict.c). Reserve() clears it.
+ *
  * 2016 K.W.E. de Lange
  */
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "strndup.h"
 #include "error.h"
 #include "str.h"
+#include "cursor.h"
+
+
+#define isHeap(obj)		((obj)->sptr != (obj)->buffer)
+#define REFCOUNT(obj)	(((size_t *)(obj)->sptr)[-1])  /* number of string-objects sharing a heap block */
+#define HASH(obj)		(((size_t *)(obj)->sptr)[-2])  /* hash value of the string, 0 if not yet calculated */
+
+
+/* Get a heap block for 'capacity' characters. The hash value and the
+ * reference count are stored in front of the characters.
+ *
+ * return	pointer to the first character
+ */
+static char *heap_alloc(size_t capacity)
+{
+	size_t *block;
+
+	if ((block = malloc(2 * sizeof(size_t) + capacity)) == NULL)
+		raise(OutOfMemoryError);
+
+	block[0] = 0;
+	block[1] = 1;
+
+	return (char *)(block + 2);
+}
+
+
+/* Remove the reference from a string-object to its heap block, and free
+ * the block if this was the last reference. Afterwards the string-object
+ * uses its own buffer again.
+ */
+static void release(StrObject *obj)
+{
+	if (isHeap(obj) && --REFCOUNT(obj) == 0)
+		free(&HASH(obj));
+
+	obj->sptr = obj->buffer;
+	obj->capacity = STRINLINE;
+}
 
 
 /* Create a new empty string-object.
@@ -28,15 +80,15 @@ static StrObject *str_alloc(void)
 {
 	StrObject *obj;
 
-	if ((obj = calloc(1, sizeof(StrObject))) != NULL) {
+	if ((obj = pool_alloc(STRSIZE)) != NULL) {
 		obj->typeobj = (TypeObject *)&strtype;
 		obj->type = STR_T;
 		obj->refcount = 0;
 
-		if ((obj->sptr = strdup("")) == NULL) {  /* initial value is empty string */
-			obj_free((Object *)obj);
-			obj = NULL;
-		}
+		obj->length = 0;  /* initial value is empty string */
+		obj->capacity = STRINLINE;
+		obj->sptr = obj->buffer;
+		obj->sptr[0] = '\0';
 	}
 	return obj;  /* returns NULL if alloc failed */
 }
@@ -47,27 +99,89 @@ static StrObject *str_alloc(void)
  */
 static void str_free(StrObject *obj)
 {
-	free(obj->sptr);
+	release(obj);
 
 	*obj = (const StrObject) { 0 };  /* clear the object struct, facilitates debugging */
 
-	free(obj);
+	pool_free(obj, STRSIZE);
 }
 
 
 static void str_print(FILE *fp, StrObject *obj)
 {
-	fprintf(fp, "%s", obj->sptr);
+	fwrite(obj->sptr, sizeof(char), obj->length, fp);
 }
 
 
-static void str_set(StrObject *obj, const char *s)
+/* Make sure a string-object can hold a string of 'length' characters, and
+ * that it can be modified because its heap block is not shared.
+ *
+ * If the string must be moved its current content is preserved. The
+ * capacity at least doubles, so repeatedly appending to a string takes
+ * amortized constant time per append.
+ */
+static void reserve(StrObject *obj, size_t length)
 {
-	if (obj->sptr)
-		free(obj->sptr);  /* free current string */
+	char *sptr;
+	size_t capacity;
 
-	if ((obj->sptr = strdup(s)) == NULL)  /* always create private copy of s */
-		raise(OutOfMemoryError);
+	if (length < obj->capacity && (isHeap(obj) == false || REFCOUNT(obj) == 1)) {
+		if (isHeap(obj))
+			HASH(obj) = 0;  /* the string is about to change */
+		return;
+	}
+
+	if (length < obj->capacity)
+		capacity = obj->capacity;  /* only unshare */
+	else
+		capacity = obj->capacity * 2 > length ? obj->capacity * 2 : length + 1;
+
+	sptr = heap_alloc(capacity);
+
+	memcpy(sptr, obj->sptr, obj->length + 1);
+
+	release(obj);
+
+	obj->sptr = sptr;
+	obj->capacity = capacity;
+}
+
+
+/* Store a copy of 'length' characters from 's' in a string-object.
+ *
+ * As 's' may be located in the string-object itself, it is copied via
+ * a temporary buffer if the string must be moved to the heap. A shared
+ * heap block is released first; it remains in existence because of the
+ * other references, so 's' stays valid.
+ */
+static void str_setn(StrObject *obj, const char *s, size_t length)
+{
+	if (isHeap(obj) && REFCOUNT(obj) > 1)
+		release(obj);
+
+	if (length >= obj->capacity && s >= obj->sptr && s < obj->sptr + obj->capacity) {
+		char *tmp;
+
+		if ((tmp = malloc(length)) == NULL)
+			raise(OutOfMemoryError);
+
+		memcpy(tmp, s, length);
+		reserve(obj, length);
+		memcpy(obj->sptr, tmp, length);
+		free(tmp);
+	} else {
+		reserve(obj, length);
+		memmove(obj->sptr, s, length);
+	}
+
+	obj->sptr[length] = '\0';
+	obj->length = length;
+}
+
+
+static void str_set(StrObject *obj, const char *s)
+{
+	str_setn(obj, s, strlen(s));
 }
 
 
@@ -77,6 +191,44 @@ static void str_vset(StrObject *obj, va_list argp)
 }
 
 
+/* Give string-object 'dest' the same content as 'src'.
+ *
+ * A string on the heap is not copied but shared, see reserve().
+ */
+static void str_share(StrObject *dest, StrObject *src)
+{
+	if (isHeap(src) == false) {
+		str_setn(dest, src->sptr, src->length);
+		return;
+	}
+
+	if (dest->sptr == src->sptr)
+		return;  /* already shared, also covers dest == src */
+
+	REFCOUNT(src)++;
+
+	release(dest);
+
+	dest->sptr = src->sptr;
+	dest->capacity = src->capacity;
+	dest->length = src->length;
+}
+
+
+/* Create a new string-object with a copy of 'length' characters from 's'.
+ *
+ * return	new string-object
+ */
+static StrObject *str_create(const char *s, size_t length)
+{
+	StrObject *obj = (StrObject *)obj_alloc(STR_T);
+
+	str_setn(obj, s, length);
+
+	return obj;
+}
+
+
 /* Execute a method on a string.
  *
  * obj			string-object for which method was called
@@ -105,6 +257,37 @@ static Object *str_method(StrObject *obj, char *name, Array *arguments)
 }
 
 
+/* Return the hash value of a string (FNV-1a).
+ *
+ * For a string on the heap the value is cached in the heap block, so it
+ * is calculated only once for all string-objects sharing the block.
+ *
+ * return	hash value, never 0
+ */
+static size_t str_hash(StrObject *obj)
+{
+	size_t hash;
+
+	if (isHeap(obj) && HASH(obj) != 0)
+		return HASH(obj);
+
+	hash = (size_t)14695981039346656037ULL;
+
+	for (size_t i = 0; i < obj->length; i++) {
+		hash ^= (unsigned char)obj->sptr[i];
+		hash *= (size_t)1099511628211ULL;
+	}
+
+	if (hash == 0)
+		hash = 1;
+
+	if (isHeap(obj))
+		HASH(obj) = hash;
+
+	return hash;
+}
+
+
 /* Return string length as an integer-object.
  *
  * return	integer-object with count or none-object in case of error
@@ -113,7 +296,7 @@ static Object *str_length(StrObject *obj)
 {
 	Object *len;
 
-	if ((len = obj_create(INT_T, strlen(obj->sptr))) == NULL)
+	if ((len = obj_int(obj->length)) == NULL)
 		len = obj_alloc(NONE_T);
 
 	return len;
@@ -130,33 +313,25 @@ static Object *str_length(StrObject *obj)
  */
 static Object *str_concat(Object *op1, Object *op2)
 {
-	char *s;
-	size_t bytes;
-	Object *obj;
-	StrObject *s1, *s2, *conv = NULL;
+	StrObject *obj, *s1, *s2, *conv = NULL;
 
 	s1 = TYPE(op1) == STR_T ? (StrObject *)op1 : (conv = (StrObject *)obj_to_strobj(op1));
 	s2 = TYPE(op2) == STR_T ? (StrObject *)op2 : (conv = (StrObject *)obj_to_strobj(op2));
 
-	bytes = strlen(s1->sptr) + strlen(s2->sptr) + 1;  /* + 1 because strlen does not count the '\0' character */
+	obj = (StrObject *)obj_alloc(STR_T);
 
-	if ((s = calloc(bytes, sizeof(char))) == NULL) {
-		raise(OutOfMemoryError);
-		return obj_alloc(NONE_T);
-	}
+	reserve(obj, s1->length + s2->length);
 
-	strcpy(s, s1->sptr);
-	strcat(s, s2->sptr);
+	memcpy(obj->sptr, s1->sptr, s1->length);
+	memcpy(obj->sptr + s1->length, s2->sptr, s2->length);
 
-	if ((obj = obj_create(STR_T, s)) == NULL)
-		obj = obj_alloc(NONE_T);
-
-	free(s);
+	obj->length = s1->length + s2->length;
+	obj->sptr[obj->length] = '\0';
 
 	if (conv)
 		obj_free((Object *)conv);
 
-	return obj;
+	return (Object *)obj;
 }
 
 
@@ -170,9 +345,7 @@ static Object *str_concat(Object *op1, Object *op2)
  */
 static Object *str_repeat(Object *op1, Object *op2)
 {
-	char *str;
-	size_t bytes;
-	Object *obj;
+	StrObject *obj;
 
 	StrObject *s = TYPE(op1) == STR_T ? (StrObject *)op1 : (StrObject *)op2;
 	Object *n = TYPE(op1) == STR_T ? op2 : op1;
@@ -182,22 +355,60 @@ static Object *str_repeat(Object *op1, Object *op2)
 	if (times < 0)
 		times = 0;
 
-	bytes = strlen(s->sptr) * times + 1;  /* + 1 because strlen() does not count the '\0' character */
+	obj = (StrObject *)obj_alloc(STR_T);
 
-	if ((str = calloc(bytes, sizeof(char))) == NULL) {  /* callocs 0's make str a zero-length string */
-		raise(OutOfMemoryError);
-		return obj_alloc(NONE_T);
-	}
+	reserve(obj, s->length * times);
 
-	while (times--)
-		strcat(str, s->sptr);
+	for (int_t i = 0; i < times; i++)
+		memcpy(obj->sptr + i * s->length, s->sptr, s->length);
 
-	if ((obj = obj_create(STR_T, str)) == NULL)
-		obj = obj_alloc(NONE_T);
+	obj->length = s->length * times;
+	obj->sptr[obj->length] = '\0';
 
-	free(str);
+	return (Object *)obj;
+}
 
-	return obj;
+
+/* Append op2 to string-object op1 (op1 += op2).
+ *
+ * Op2 can be anything and will be converted to a string.
+ */
+static void str_iconcat(StrObject *op1, Object *op2)
+{
+	StrObject *s2 = (StrObject *)obj_to_strobj(op2);
+	size_t length = s2->length;  /* op2 may be op1 itself */
+
+	reserve(op1, op1->length + length);
+
+	memcpy(op1->sptr + op1->length, s2->sptr, length);
+
+	op1->length += length;
+	op1->sptr[op1->length] = '\0';
+
+	obj_decref((Object *)s2);
+}
+
+
+/* Repeat the content of string-object op1 n times (op1 *= n).
+ *
+ * Operand n is guaranteed to be number-object. If it is negative it will
+ * be silently adjusted to 0.
+ */
+static void str_irepeat(StrObject *op1, Object *n)
+{
+	size_t length = op1->length;
+	int_t times = obj_as_int(n);
+
+	if (times < 0)
+		times = 0;
+
+	reserve(op1, length * times);
+
+	for (int_t i = 1; i < times; i++)
+		memcpy(op1->sptr + i * length, op1->sptr, length);
+
+	op1->length = length * times;
+	op1->sptr[op1->length] = '\0';
 }
 
 
@@ -209,7 +420,7 @@ static Object *str_eql(StrObject *op1, StrObject *op2)
 {
 	Object *result;
 
-	result = obj_create(INT_T, (int_t)(strcmp(op1->sptr, op2->sptr) == 0 ? 1 : 0));
+	result = obj_bool(op1->length == op2->length && memcmp(op1->sptr, op2->sptr, op1->length) == 0);
 
 	if (result == NULL)
 		result = obj_alloc(NONE_T);
@@ -226,7 +437,7 @@ static Object *str_neq(StrObject *op1, StrObject *op2)
 {
 	Object *result;
 
-	result = obj_create(INT_T, (int_t)!(strcmp(op1->sptr, op2->sptr) == 0 ? 1 : 0));
+	result = obj_bool(op1->length != op2->length || memcmp(op1->sptr, op2->sptr, op1->length) != 0);
 
 	if (result == NULL)
 		result = obj_alloc(NONE_T);
@@ -235,31 +446,71 @@ static Object *str_neq(StrObject *op1, StrObject *op2)
 }
 
 
+/* Compare two strings byte by byte, as unsigned characters. If one string
+ * is the beginning of the other the shorter one comes first. This is the
+ * order of the comparison operators and of list.sort().
+ *
+ * return	< 0 if op1 comes before op2, 0 if equal, > 0 if op1 comes after op2
+ */
+static int str_compare(StrObject *op1, StrObject *op2)
+{
+	int d = memcmp(op1->sptr, op2->sptr, op1->length < op2->length ? op1->length : op2->length);
+
+	if (d != 0)
+		return d;
+
+	return (op1->length > op2->length) - (op1->length < op2->length);
+}
+
+
+static Object *str_lss(StrObject *op1, StrObject *op2)
+{
+	return obj_bool(str_compare(op1, op2) < 0);
+}
+
+
+static Object *str_leq(StrObject *op1, StrObject *op2)
+{
+	return obj_bool(str_compare(op1, op2) <= 0);
+}
+
+
+static Object *str_gtr(StrObject *op1, StrObject *op2)
+{
+	return obj_bool(str_compare(op1, op2) > 0);
+}
+
+
+static Object *str_geq(StrObject *op1, StrObject *op2)
+{
+	return obj_bool(str_compare(op1, op2) >= 0);
+}
+
+
 /* Retrieve a character from a string object by index.
+ *
+ * The character is returned as immediate, so indexing a string does not
+ * allocate memory.
  *
  * obj		string-object to retrieve the object from
  * index	index number of object, negative numbers count from the end
  * return	retrieved character-object or none-object in case of error
  */
-static CharObject *str_item(StrObject *obj, int_t index)
+static Object *str_item(StrObject *obj, int_t index)
 {
-	CharObject *c;
 	int_t len;
 
-	len = strlen(obj->sptr);
+	len = obj->length;
 
 	if (index < 0)
 		index += len;
 
 	if (index < 0 || index >= len) {
 		raise(IndexError);
-		return (CharObject *)obj_alloc(NONE_T);
+		return obj_alloc(NONE_T);
 	}
 
-	if ((c = (CharObject *)obj_create(CHAR_T, *(obj->sptr + index))) == NULL)
-		c = (CharObject *)obj_alloc(NONE_T);
-
-	return c;
+	return obj_char(obj->sptr[index]);
 }
 
 
@@ -274,10 +525,7 @@ static CharObject *str_item(StrObject *obj, int_t index)
  */
 static StrObject *str_slice(StrObject *obj, int_t start, int_t end)
 {
-	StrObject *slice;
-	char *str;
-
-	int_t len = strlen(obj->sptr);
+	int_t len = obj->length;
 
 	if (start < 0)
 		start += len;
@@ -291,15 +539,55 @@ static StrObject *str_slice(StrObject *obj, int_t start, int_t end)
 	if (end >= len)
 		end = len;
 
-	if ((str = strndup(obj->sptr + start, end - start)) == NULL)
-		return (StrObject *)obj_alloc(NONE_T);
+	return str_create(obj->sptr + start, end > start ? end - start : 0);
+}
+
+
+/* Start iterating over a string.
+ */
+static void str_begin(StrObject *obj, CursorObject *cursor)
+{
+	cursor->index = 0;
+	cursor->end = obj->length;
+}
+
+
+/* Return the next character of a string without creating an object. The
+ * for-in loops use this to store the character in the loop variable via
+ * frame_bind_char().
+ *
+ * return	character as unsigned value or -1 if there are no characters left
+ */
+static int str_nextchar(CursorObject *cursor)
+{
+	StrObject *obj = (StrObject *)cursor->sequence;
+
+	if (cursor->index >= cursor->end)
+		return -1;
 
-	if ((slice = (StrObject *)obj_create(STR_T, str)) == NULL)
-		slice = (StrObject *)obj_alloc(NONE_T);
+	if ((size_t)cursor->index >= obj->length) {  /* the string was shortened in the loop */
+		raise(IndexError);
+		return -1;
+	}
 
-	free(str);
+	return (unsigned char)obj->sptr[cursor->index++];
+}
+
+
+/* Return the next character of a string in a new char-object, for users
+ * of obj_next() which need an object. The string may have been shortened
+ * while iterating, see str_nextchar().
+ *
+ * return	new char-object or NULL if there are no characters left
+ */
+static Object *str_next(CursorObject *cursor)
+{
+	int c = str_nextchar(cursor);
 
-	return slice;
+	if (c < 0)
+		return NULL;
+
+	return obj_create(CHAR_T, (char_t)c);
 }
 
 
@@ -313,12 +601,42 @@ StrType strtype = {
 	.set = str_set,
 	.vset = (void (*)(Object *, va_list))str_vset,
 	.method = (Object *(*)(Object *, char *, Array *))str_method,
+	.begin = (void (*)(Object *, struct cursor *))str_begin,
+	.next = str_next,
 
+	.create = str_create,
+	.setn = str_setn,
+	.share = str_share,
 	.length = str_length,
+	.hash = str_hash,
+	.compare = str_compare,
 	.item = str_item,
+	.nextchar = str_nextchar,
 	.slice = str_slice,
-	.concat = str_concat,
-	.repeat = str_repeat,
-	.eql = (Object *(*)(Object *, Object *))str_eql,
-	.neq = (Object *(*)(Object *, Object *))str_neq
+	.iconcat = str_iconcat,
+	.irepeat = str_irepeat
 	};
+
+
+/* Register the kernels for the binary operators on strings (see object.h).
+ * Any operand can be concatenated to a string.
+ */
+void str_register(void)
+{
+	for (objecttype_t type = CHAR_T; type <= NONE_T; type++) {
+		obj_register(OBJ_ADD, STR_T, type, str_concat);
+		obj_register(OBJ_ADD, type, STR_T, str_concat);
+	}
+
+	for (objecttype_t type = CHAR_T; type <= FLOAT_T; type++) {
+		obj_register(OBJ_MUL, STR_T, type, str_repeat);
+		obj_register(OBJ_MUL, type, STR_T, str_repeat);
+	}
+
+	obj_register(OBJ_EQL, STR_T, STR_T, (kernel_t)str_eql);
+	obj_register(OBJ_NEQ, STR_T, STR_T, (kernel_t)str_neq);
+	obj_register(OBJ_LSS, STR_T, STR_T, (kernel_t)str_lss);
+	obj_register(OBJ_LEQ, STR_T, STR_T, (kernel_t)str_leq);
+	obj_register(OBJ_GTR, STR_T, STR_T, (kernel_t)str_gtr);
+	obj_register(OBJ_GEQ, STR_T, STR_T, (kernel_t)str_geq);
+}
@@ -7,23 +7,46 @@
 
 #include "object.h"
 #include "number.h"
+#include "pool.h"
 
+/* A string object knows the length of its string, so embedded '\0'
+ * characters are allowed. Nevertheless the string is always terminated
+ * by a '\0' so it can also be used as a C string. Short strings are
+ * stored in the object itself, in 'buffer'. Longer strings are stored
+ * on the heap. Field sptr points to where the string is actually stored.
+ * A string on the heap can be shared by several string objects, see str.c.
+ */
 typedef struct {
 	OBJ_HEAD;
-	char *sptr;
+	size_t length;		/* number of characters, excluding the terminating '\0' */
+	size_t capacity;	/* number of bytes available at sptr */
+	char *sptr;			/* points to buffer or to a string on the heap */
+	char buffer[];		/* room for a short string, see STRINLINE */
 } StrObject;
 
+/* A string object always occupies the largest pool block. What remains
+ * after the header is available for short strings.
+ */
+#define STRSIZE		(POOLCLASSES * POOLGRANULE)
+#define STRINLINE	(STRSIZE - sizeof(StrObject))
+
 typedef struct {
 	TYPE_HEAD;
+	StrObject *(*create)(const char *s, size_t length);
+	void (*setn)(StrObject *obj, const char *s, size_t length);
+	void (*share)(StrObject *dest, StrObject *src);
 	Object *(*length)(StrObject *obj);
-	CharObject *(*item)(StrObject *str, int_t index);
+	size_t (*hash)(StrObject *obj);
+	int (*compare)(StrObject *op1, StrObject *op2);
+	Object *(*item)(StrObject *str, int_t index);
+	int (*nextchar)(struct cursor *cursor);
 	StrObject *(*slice)(StrObject *obj, int_t start, int_t end);
-	Object *(*concat)(Object *op1, Object *op2);
-	Object *(*repeat)(Object *op1, Object *op2);
-	Object *(*eql)(Object *op1, Object *op2);
-	Object *(*neq)(Object *op1, Object *op2);
+	void (*iconcat)(StrObject *op1, Object *op2);
+	void (*irepeat)(StrObject *op1, Object *n);
 } StrType;
 
 extern StrType strtype;
 
+extern void str_register(void);
+
 #endif
@@ -17,17 +17,24 @@
 #include "identifier.h"
 #include "function.h"
 #include "scanner.h"
+#include "frame.h"
 #include "object.h"
 #include "array.h"
 #include "error.h"
 #include "visit.h"
 #include "list.h"
+#include "number.h"
+#include "str.h"
+#include "range.h"
+#include "cursor.h"
 
 
 static int do_break = 0;	/* If true busy quitting loop because of break */
 static int do_continue = 0;	/* If true busy quitting loop because of continue */
 static int do_return = 0;	/* If true busy exiting block or module because of return */
 
+static int loop_depth = 0;	/* During check() number of enclosing loops */
+
 
 Node *current_node = NULL;	/* During check() and visit() used to keep track of the node
 							 * currently executed for easy error reporting. NULL while
@@ -94,6 +101,10 @@ void check(Node *n)
 
 	n->check(n);
 
+	if (n->method.valid)
+		for (size_t i = 0; i != n->method.arguments->size; i++)
+			check(n->method.arguments->element[i]);
+
 	current_node = tmp;
 }
 
@@ -112,15 +123,15 @@ void visit(Node *n, Stack *s)
 
 	if (n->method.valid) {
 		Array *arguments = array.alloc();
-		Object *obj = stack.pop(s);
+		Object *obj = stack_pop(s);
 
 		/* visit all arguments and put resulting object in array arguments */
 		for (size_t i = 0; i < n->method.arguments->size; i++) {
 			visit(n->method.arguments->element[i], s);
-			array.append_child(arguments, stack.pop(s));
+			array.append_child(arguments, stack_pop(s));
 		}
 
-		stack.push(s, obj_method(isListNode(obj) ? obj_from_listnode(obj) : obj, n->method.name, arguments));
+		stack_push(s, obj_method(obj, n->method.name, arguments));
 
 		for (size_t i = 0; i < n->method.arguments->size; i++)
 			obj_decref(arguments->element[i]);
@@ -160,7 +171,7 @@ void check_block(Node *n)
 
 void visit_block(Node *n, Stack *s)
 {
-	for (size_t i = 0; i != n->block.statements->size && !(do_break || do_continue); i++)
+	for (size_t i = 0; i != n->block.statements->size && !(do_break || do_continue || do_return); i++)
 		visit(n->block.statements->element[i], s);
 }
 
@@ -184,18 +195,23 @@ void print_literal(Node *n, int level)
 
 void check_literal(Node *n)
 {
+	Object *obj = NULL;
+
+	if (n->literal.constant)
+		return;  /* already checked */
+
 	switch (n->literal.type) {
 		case VT_CHAR:
-			str_to_char(n->literal.value);  /* only check if conversion is possible */
+			obj = obj_create(CHAR_T, str_to_char(n->literal.value));  /* also checks if conversion is possible */
 			break;
 		case VT_INT:
-			str_to_int(n->literal.value);
+			obj = obj_create(INT_T, str_to_int(n->literal.value));
 			break;
 		case VT_FLOAT:
-			str_to_float(n->literal.value);
+			obj = obj_create(FLOAT_T, str_to_float(n->literal.value));
 			break;
 		case VT_STR:
-			/* nothing to check here n->literal.value is already a string */
+			obj = obj_create(STR_T, n->literal.value);
 			break;
 		case VT_LIST:
 			raise(DesignError, "literals of type VT_LIST are not implemented");
@@ -204,27 +220,20 @@ void check_literal(Node *n)
 			raise(DesignError, "unknown literal type %d", n->literal.type);
 			break;
 	}
+
+	if (obj == NULL)
+		raise(OutOfMemoryError);
+
+	obj->refcount = IMMORTAL;  /* shared by every evaluation of this literal */
+
+	n->literal.constant = obj;
 }
 
 
 void visit_literal(Node *n, Stack *s)
 {
-	switch (n->literal.type) {
-		case VT_CHAR:
-			stack.push(s, obj_create(CHAR_T, str_to_char(n->literal.value)));
-			break;
-		case VT_INT:
-			stack.push(s, obj_create(INT_T, str_to_int(n->literal.value)));
-			break;
-		case VT_FLOAT:
-			stack.push(s, obj_create(FLOAT_T, str_to_float(n->literal.value)));
-			break;
-		case VT_STR:
-			stack.push(s, obj_create(STR_T, n->literal.value));
-			break;
-		default:
-			break;
-	}
+	obj_incref(n->literal.constant);
+	stack_push(s, n->literal.constant);
 }
 
 
@@ -260,13 +269,13 @@ void visit_unary(Node *n, Stack *s)
 
 	switch (n->unary.operator) {
 		case UNOT:
-			obj = stack.pop(s);
-			stack.push(s, obj_negate(obj));
+			obj = stack_pop(s);
+			stack_push(s, obj_negate(obj));
 			obj_decref(obj);
 			break;
 		case UMINUS:
-			obj = stack.pop(s);
-			stack.push(s, obj_invert(obj));
+			obj = stack_pop(s);
+			stack_push(s, obj_invert(obj));
 			obj_decref(obj);
 			break;
 		case UPLUS:
@@ -312,60 +321,319 @@ void check_binary(Node *n)
 }
 
 
-void visit_binary(Node *n, Stack *s)
+/* Apply a binary operator on two operands via the generic obj_...() functions.
+ * The caller releases the left operand afterwards, so arithmetic may store
+ * its result in it (see obj_add_tmp()).
+ */
+static Object *binary(binaryoperator_t operator, Object *left, Object *right)
 {
-	Object *left, *right;
-
-	visit(n->binary.left, s);
-	left = stack.pop(s);
-
-	visit(n->binary.right, s);
-	right = stack.pop(s);
-
-	switch (n->binary.operator) {
+	switch (operator) {
 		case ADD:
-			stack.push(s, obj_add(left, right));
-			break;
+			return obj_add_tmp(left, right);
 		case SUB:
-			stack.push(s, obj_sub(left, right));
-			break;
+			return obj_sub_tmp(left, right);
 		case MUL:
-			stack.push(s, obj_mult(left, right));
-			break;
+			return obj_mult_tmp(left, right);
 		case DIV:
-			stack.push(s, obj_divs(left, right));
-			break;
+			return obj_divs_tmp(left, right);
 		case MOD:
-			stack.push(s, obj_mod(left, right));
-			break;
+			return obj_mod_tmp(left, right);
 		case LSS:
-			stack.push(s, obj_lss(left, right));
-			break;
+			return obj_lss(left, right);
 		case LEQ:
-			stack.push(s, obj_leq(left, right));
-			break;
+			return obj_leq(left, right);
 		case GTR:
-			stack.push(s, obj_gtr(left, right));
-			break;
+			return obj_gtr(left, right);
 		case GEQ:
-			stack.push(s, obj_geq(left, right));
-			break;
+			return obj_geq(left, right);
 		case EQ:
-			stack.push(s, obj_eql(left, right));
-			break;
+			return obj_eql(left, right);
 		case NEQ:
-			stack.push(s, obj_neq(left, right));
-			break;
+			return obj_neq(left, right);
 		case OP_IN:
-			stack.push(s, obj_in(left, right));
-			break;
+			return obj_in(left, right);
 		case LOGICAL_AND:
-			stack.push(s, obj_and(left, right));
-			break;
+			return obj_and(left, right);
 		case LOGICAL_OR:
-			stack.push(s, obj_or(left, right));
+			return obj_or(left, right);
+	}
+	return obj_alloc(NONE_T);
+}
+
+
+/* Quickening.
+ *
+ * A BINARY or ASSIGNMENT node starts with a generic visit function which
+ * lets the obj_...() functions find out what to do with the operands. After
+ * its first execution the node looks at the types of its operands. If
+ * these are two integers, two floats or (for +) two strings it replaces
+ * its visit function by one which is specialized for these types, so
+ * loops which always see the same types skip the generic dispatch.
+ *
+ * A specialized function first checks if the operands still have the
+ * expected types (the guard). If not it uses the generic path and the node
+ * reverts to the generic visit function for good.
+ */
+void visit_binary(Node *n, Stack *s);
+static void visit_binary_int(Node *n, Stack *s);
+static void visit_binary_float(Node *n, Stack *s);
+static void visit_binary_str(Node *n, Stack *s);
+
+
+static void quicken_binary(Node *n, Object *left, Object *right)
+{
+	objecttype_t type = TYPE(left);
+
+	if (n->binary.polymorphic == true || type != TYPE(right))
+		return;
+
+	switch (n->binary.operator) {
+		case MOD:
+			if (type == FLOAT_T)
+				return;
+			/* fall through */
+		case SUB:
+		case MUL:
+		case DIV:
+		case LSS:
+		case LEQ:
+		case GTR:
+		case GEQ:
+		case EQ:
+		case NEQ:
+			if (type == STR_T)
+				return;
+			/* fall through */
+		case ADD:
+			if (type == INT_T)
+				n->visit = visit_binary_int;
+			else if (type == FLOAT_T)
+				n->visit = visit_binary_float;
+			else if (type == STR_T)
+				n->visit = visit_binary_str;
+			break;
+		default:
 			break;
 	}
+}
+
+
+static void deoptimize_binary(Node *n)
+{
+	n->visit = visit_binary;
+	n->binary.polymorphic = true;
+}
+
+
+/* Logical and/or with short-circuit evaluation. The right operand is only
+ * evaluated if the left operand does not already determine the result.
+ * Just like the kernels for and and or in number.c the result is integer 0 or 1.
+ */
+static void visit_logical(Node *n, Stack *s)
+{
+	Object *left, *right, *result;
+
+	visit(n->binary.left, s);
+	left = stack_pop(s);
+
+	if (isNumber(left) && obj_as_bool(left) == (n->binary.operator == LOGICAL_OR))
+		result = obj_bool(n->binary.operator == LOGICAL_OR);  /* left operand decides */
+	else {
+		visit(n->binary.right, s);
+		right = stack_pop(s);
+
+		result = binary(n->binary.operator, left, right);  /* also checks the operand types */
+
+		obj_decref(right);
+	}
+
+	obj_decref(left);
+
+	stack_push(s, result);
+}
+
+
+void visit_binary(Node *n, Stack *s)
+{
+	Object *left, *right;
+
+	if (n->binary.operator == LOGICAL_AND || n->binary.operator == LOGICAL_OR) {
+		n->visit = visit_logical;  /* from now on skip this test */
+		visit_logical(n, s);
+		return;
+	}
+
+	visit(n->binary.left, s);
+	left = stack_pop(s);
+
+	visit(n->binary.right, s);
+	right = stack_pop(s);
+
+	stack_push(s, binary(n->binary.operator, left, right));
+
+	quicken_binary(n, left, right);
+
+	obj_decref(left);
+	obj_decref(right);
+}
+
+
+static void visit_binary_int(Node *n, Stack *s)
+{
+	Object *left, *right, *result;
+
+	visit(n->binary.left, s);
+	left = stack_pop(s);
+
+	visit(n->binary.right, s);
+	right = stack_pop(s);
+
+	if (TYPE(left) == INT_T && TYPE(right) == INT_T) {
+		int_t l = int_value(left);
+		int_t r = int_value(right);
+
+		switch (n->binary.operator) {
+			case ADD:
+				result = obj_int(l + r);
+				break;
+			case SUB:
+				result = obj_int(l - r);
+				break;
+			case MUL:
+				result = obj_int(l * r);
+				break;
+			case DIV:
+				result = r ? obj_int(l / r) : binary(DIV, left, right);  /* raises the error */
+				break;
+			case MOD:
+				result = r ? obj_int(l % r) : binary(MOD, left, right);
+				break;
+			case LSS:
+				result = obj_bool(l < r);
+				break;
+			case LEQ:
+				result = obj_bool(l <= r);
+				break;
+			case GTR:
+				result = obj_bool(l > r);
+				break;
+			case GEQ:
+				result = obj_bool(l >= r);
+				break;
+			case EQ:
+				result = obj_bool(l == r);
+				break;
+			case NEQ:
+				result = obj_bool(l != r);
+				break;
+			default:
+				result = binary(n->binary.operator, left, right);
+		}
+	} else {
+		deoptimize_binary(n);
+		result = binary(n->binary.operator, left, right);
+	}
+
+	stack_push(s, result);
+
+	obj_decref(left);
+	obj_decref(right);
+}
+
+
+/* Return a float-object for the result of an arithmetic operation. The left
+ * operand is reused if it is a temporary.
+ */
+static Object *float_result(Object *left, float_t f)
+{
+	if (isTemporary(left) == false)
+		return obj_create(FLOAT_T, f);
+
+	((FloatObject *)left)->fval = f;
+	obj_incref(left);
+
+	return left;
+}
+
+
+static void visit_binary_float(Node *n, Stack *s)
+{
+	Object *left, *right, *result;
+
+	visit(n->binary.left, s);
+	left = stack_pop(s);
+
+	visit(n->binary.right, s);
+	right = stack_pop(s);
+
+	if (TYPE(left) == FLOAT_T && TYPE(right) == FLOAT_T) {
+		float_t l = ((FloatObject *)left)->fval;
+		float_t r = ((FloatObject *)right)->fval;
+
+		switch (n->binary.operator) {
+			case ADD:
+				result = float_result(left, l + r);
+				break;
+			case SUB:
+				result = float_result(left, l - r);
+				break;
+			case MUL:
+				result = float_result(left, l * r);
+				break;
+			case DIV:
+				result = r ? float_result(left, l / r) : binary(DIV, left, right);  /* raises the error */
+				break;
+			case LSS:
+				result = obj_bool(l < r);
+				break;
+			case LEQ:
+				result = obj_bool(l <= r);
+				break;
+			case GTR:
+				result = obj_bool(l > r);
+				break;
+			case GEQ:
+				result = obj_bool(l >= r);
+				break;
+			case EQ:
+				result = obj_bool(l == r);
+				break;
+			case NEQ:
+				result = obj_bool(l != r);
+				break;
+			default:
+				result = binary(n->binary.operator, left, right);
+		}
+	} else {
+		deoptimize_binary(n);
+		result = binary(n->binary.operator, left, right);
+	}
+
+	stack_push(s, result);
+
+	obj_decref(left);
+	obj_decref(right);
+}
+
+
+static void visit_binary_str(Node *n, Stack *s)
+{
+	Object *left, *right, *result;
+
+	visit(n->binary.left, s);
+	left = stack_pop(s);
+
+	visit(n->binary.right, s);
+	right = stack_pop(s);
+
+	if (TYPE(left) == STR_T && TYPE(right) == STR_T)
+		result = obj_add_tmp(left, right);  /* only + is quickened for strings */
+	else {
+		deoptimize_binary(n);
+		result = binary(n->binary.operator, left, right);
+	}
+
+	stack_push(s, result);
 
 	obj_decref(left);
 	obj_decref(right);
@@ -393,7 +661,7 @@ void visit_comma_expr(Node *n, Stack *s)
 		if (i == n->comma_expr.expressions->size - 1)
 			break;  /* last expression reached */
 		else
-			obj_decref(stack.pop(s));  /* only result from last expression is used */
+			obj_decref(stack_pop(s));  /* only result from last expression is used */
 	}
 }
 
@@ -420,12 +688,12 @@ void visit_arglist(Node *n, Stack *s)
 
 	for (size_t i = 0; i != n->arglist.arguments->size; i++) {
 		visit(n->arglist.arguments->element[i], s);
-		arg = stack.pop(s);
+		arg = stack_pop(s);
 		listtype.append((ListObject *)obj, obj_copy(arg));
 		obj_decref(arg);
 	}
 
-	stack.push(s, obj);
+	stack_push(s, obj);
 }
 
 
@@ -448,17 +716,17 @@ void visit_index(Node *n, Stack *s)
 	Object *obj, *sequence, *index;
 
 	visit(n->index.sequence, s);
-	sequence = stack.pop(s);
+	sequence = stack_pop(s);
 
 	visit(n->index.index, s);
-	index = stack.pop(s);
+	index = stack_pop(s);
 
-	obj = obj_item(sequence, obj_as_int(index));
+	obj = obj_subscript(sequence, index);
 
 	obj_decref(index);
 	obj_decref(sequence);
 
-	stack.push(s, obj);
+	stack_push(s, obj);
 }
 
 
@@ -483,13 +751,13 @@ void visit_slice(Node *n, Stack *s)
 	Object *obj, *sequence, *start, *end;
 
 	visit(n->slice.sequence, s);
-	sequence = stack.pop(s);
+	sequence = stack_pop(s);
 
 	visit(n->slice.start, s);
-	start = stack.pop(s);
+	start = stack_pop(s);
 
 	visit(n->slice.end, s);
-	end = stack.pop(s);
+	end = stack_pop(s);
 
 	obj = obj_slice(sequence, obj_as_int(start), obj_as_int(end));
 
@@ -497,7 +765,92 @@ void visit_slice(Node *n, Stack *s)
 	obj_decref(start);
 	obj_decref(sequence);
 
-	stack.push(s, obj);
+	stack_push(s, obj);
+}
+
+
+void print_index_store(Node *n, int level)
+{
+	printf_indent(level + 1, "OPERATOR %s\n", assignmentoperatorName(n->index_store.operator));
+
+	print(n->index_store.sequence, level + 1);
+	print(n->index_store.index, level + 1);
+	print(n->index_store.expression, level + 1);
+}
+
+
+void check_index_store(Node *n)
+{
+	check(n->index_store.sequence);
+	check(n->index_store.index);
+	check(n->index_store.expression);
+}
+
+
+void visit_index_store(Node *n, Stack *s)
+{
+	Object *obj, *sequence, *index, *value;
+
+	visit(n->index_store.sequence, s);
+	sequence = stack_pop(s);
+
+	visit(n->index_store.index, s);
+	index = stack_pop(s);
+
+	visit(n->index_store.expression, s);
+	value = stack_pop(s);
+
+	obj = obj_store_item(sequence, index, value);
+
+	obj_decref(value);
+	obj_decref(index);
+	obj_decref(sequence);
+
+	stack_push(s, obj);
+}
+
+
+/* Function which calculates the new value of an element for a compound
+ * assignment. The list holding the element releases it afterwards, so
+ * just like in binary() the arithmetic may store its result in it.
+ */
+static kernel_t arithmetic(assignmentoperator_t operator)
+{
+	switch (operator) {
+		case ADDASSIGN:
+			return obj_add_tmp;
+		case SUBASSIGN:
+			return obj_sub_tmp;
+		case MULASSIGN:
+			return obj_mult_tmp;
+		case DIVASSIGN:
+			return obj_divs_tmp;
+		default:  /* MODASSIGN */
+			return obj_mod_tmp;
+	}
+}
+
+
+void visit_index_update(Node *n, Stack *s)
+{
+	Object *obj, *sequence, *index, *value;
+
+	visit(n->index_store.sequence, s);
+	sequence = stack_pop(s);
+
+	visit(n->index_store.index, s);
+	index = stack_pop(s);
+
+	visit(n->index_store.expression, s);
+	value = stack_pop(s);
+
+	obj = obj_update_item(sequence, index, arithmetic(n->index_store.operator), value);
+
+	obj_decref(value);
+	obj_decref(index);
+	obj_decref(sequence);
+
+	stack_push(s, obj);
 }
 
 
@@ -530,44 +883,216 @@ void check_assignment(Node *n)
 }
 
 
-void visit_assignment(Node *n, Stack *s)
+/* Evaluate the target of an assignment. For a variable this is the object
+ * which is bound to it. This is not necessarily its value, because the
+ * variable of a for-in loop is bound to a listnode.
+ */
+static Object *assignment_target(Node *variable, Stack *s)
 {
-	Object *target, *value, *tmp;
+	Object *obj;
 
-	visit(n->assignment.variable, s);
-	target = stack.pop(s);
+	if (variable->type == REFERENCE && variable->method.valid == false) {
+		if ((obj = frame_object(variable->reference.location.depth, variable->reference.location.slot)) == NULL)
+			raise(NameError, "variable %s has no value", variable->reference.name);
 
-	visit(n->assignment.expression, s);
-	value = stack.pop(s);
+		obj_incref(obj);
+		return obj;
+	}
+
+	visit(variable, s);
+	return stack_pop(s);
+}
+
+
+/* Calculate the new value of an assignment target via the generic
+ * obj_...() functions. The target is modified in place.
+ *
+ * return	target, or a copy of the target if this was a constant or an
+ *			immediate, or the element for a listnode
+ */
+static Object *assignment(Node *n, Object *target, Object *value)
+{
+	Object *tmp;
+
+	if (is_constant(n->assignment.variable) || isImmediate(target)) {  /* never modify a shared constant or an immediate */
+		tmp = target;
+		target = obj_copy(tmp);
+		obj_decref(tmp);
+	}
 
 	switch (n->assignment.operator) {
 		case ASSIGN:
-			tmp = obj_copy(value);
+			obj_assign(target, value);
 			break;
 		case ADDASSIGN:
-			tmp = obj_add(target, value);
+			obj_iadd(target, value);
 			break;
 		case SUBASSIGN:
-			tmp = obj_sub(target, value);
+			obj_isub(target, value);
 			break;
 		case MULASSIGN:
-			tmp = obj_mult(target, value);
+			obj_imult(target, value);
 			break;
 		case DIVASSIGN:
-			tmp = obj_divs(target, value);
+			obj_idivs(target, value);
 			break;
 		case MODASSIGN:
-			tmp = obj_mod(target, value);
+			obj_imod(target, value);
 			break;
-		default:
-			tmp = obj_alloc(NONE_T);
 	}
 
-	obj_assign(target, tmp);
-	obj_decref(tmp);
+	if (isListNode(target)) {  /* the result is the element which was assigned */
+		tmp = target;
+		target = obj_from_listnode(tmp);
+		obj_decref(tmp);
+	}
+
+	return target;
+}
+
+
+/* Quickening of assignments, see quicken_binary(). When the target and the
+ * value are both integers or both floats the target is modified in place.
+ */
+void visit_assignment(Node *n, Stack *s);
+static void visit_assignment_int(Node *n, Stack *s);
+static void visit_assignment_float(Node *n, Stack *s);
+
+
+static void quicken_assignment(Node *n, Object *target, Object *value)
+{
+	objecttype_t type = TYPE(target);
+
+	if (n->assignment.polymorphic == true || type != TYPE(value) || is_constant(n->assignment.variable))
+		return;
+
+	if (type == INT_T)
+		n->visit = visit_assignment_int;
+	else if (type == FLOAT_T && n->assignment.operator != MODASSIGN)
+		n->visit = visit_assignment_float;
+}
+
+
+static void deoptimize_assignment(Node *n)
+{
+	n->visit = visit_assignment;
+	n->assignment.polymorphic = true;
+}
+
+
+void visit_assignment(Node *n, Stack *s)
+{
+	Object *target, *value;
+
+	target = assignment_target(n->assignment.variable, s);
+
+	visit(n->assignment.expression, s);
+	value = stack_pop(s);
+
+	target = assignment(n, target, value);
+
+	quicken_assignment(n, target, value);
+
+	obj_decref(value);
+
+	stack_push(s, target);
+}
+
+
+static void visit_assignment_int(Node *n, Stack *s)
+{
+	Object *target, *value;
+
+	target = assignment_target(n->assignment.variable, s);
+
+	visit(n->assignment.expression, s);
+	value = stack_pop(s);
+
+	if (TYPE(target) == INT_T && isImmediate(target) == false && TYPE(value) == INT_T) {
+		int_t *t = &((IntObject *)target)->ival;
+		int_t v = int_value(value);
+
+		switch (n->assignment.operator) {
+			case ASSIGN:
+				*t = v;
+				break;
+			case ADDASSIGN:
+				*t += v;
+				break;
+			case SUBASSIGN:
+				*t -= v;
+				break;
+			case MULASSIGN:
+				*t *= v;
+				break;
+			case DIVASSIGN:
+				if (v)
+					*t /= v;
+				else
+					target = assignment(n, target, value);  /* raises the error */
+				break;
+			case MODASSIGN:
+				if (v)
+					*t %= v;
+				else
+					target = assignment(n, target, value);
+				break;
+		}
+	} else {
+		deoptimize_assignment(n);
+		target = assignment(n, target, value);
+	}
+
+	obj_decref(value);
+
+	stack_push(s, target);
+}
+
+
+static void visit_assignment_float(Node *n, Stack *s)
+{
+	Object *target, *value;
+
+	target = assignment_target(n->assignment.variable, s);
+
+	visit(n->assignment.expression, s);
+	value = stack_pop(s);
+
+	if (TYPE(target) == FLOAT_T && TYPE(value) == FLOAT_T) {
+		float_t *t = &((FloatObject *)target)->fval;
+		float_t v = ((FloatObject *)value)->fval;
+
+		switch (n->assignment.operator) {
+			case ASSIGN:
+				*t = v;
+				break;
+			case ADDASSIGN:
+				*t += v;
+				break;
+			case SUBASSIGN:
+				*t -= v;
+				break;
+			case MULASSIGN:
+				*t *= v;
+				break;
+			case DIVASSIGN:
+				if (v)
+					*t /= v;
+				else
+					target = assignment(n, target, value);  /* raises the error */
+				break;
+			default:
+				target = assignment(n, target, value);
+				break;
+		}
+	} else {
+		deoptimize_assignment(n);
+		target = assignment(n, target, value);
+	}
+
 	obj_decref(value);
 
-	stack.push(s, target);
+	stack_push(s, target);
 }
 
 
@@ -586,17 +1111,24 @@ void check_reference(Node *n)
 
 	if (id->type != VARIABLE)
 		raise(TypeError, "identifier %s is not a variable", n->reference.name);
+
+	n->reference.location = (Location) { id->depth, id->slot };
 }
 
 
 void visit_reference(Node *n, Stack *s)
 {
-	Identifier *id;
+	Object *obj;
 
-	id = identifier.search(n->reference.name);
+	if ((obj = frame_object(n->reference.location.depth, n->reference.location.slot)) == NULL)
+		raise(NameError, "variable %s has no value", n->reference.name);
 
-	obj_incref(id->object);
-	stack.push(s, id->object);
+	if (isListNode(obj))  /* variable of a for-in loop, its value is the list element */
+		obj = obj_from_listnode(obj);
+	else
+		obj_incref(obj);
+
+	stack_push(s, obj);
 }
 
 
@@ -613,35 +1145,42 @@ void print_function_call(Node *n, int level)
 void check_function_call(Node *n)
 {
 	Identifier *id;
+	char *optional;
 
-	if (n->function_call.builtin == false) {
-		if (n->function_call.checked == false) {
-			n->function_call.checked = true;  /* avoid recursive checks in case of recursive function calls */
-
-			if ((id = identifier.search(n->function_call.name)) == NULL)
-				raise(NameError, "identifier %s is not defined", n->function_call.name);
-
-			if (id->node->type != FUNCTION_DECLARATION)
-				raise(TypeError, "identifier %s is not a function", n->function_call.name);
+	if (n->function_call.builtin == true) {  /* supply the default value for an omitted last argument */
+		optional = builtin_optional(n->function_call.name);
+		if (optional && n->function_call.arguments->size + 1 == builtin_argc(n->function_call.name))
+			array.append_child(n->function_call.arguments, create(LITERAL, VT_INT, optional));
+	}
 
-			if (id->node->function_declaration.arguments->size != n->function_call.arguments->size)
-				raise(SyntaxError, "%d argument(s) expected, %d found", \
-								   id->node->function_declaration.arguments->size, n->function_call.arguments->size);
+	for (size_t i = 0; i != n->function_call.arguments->size; i++)
+		check(n->function_call.arguments->element[i]);
 
-			scope.append_level(id->node->function_declaration.nested);
+	if (n->function_call.builtin == false) {
+		/* the function body has already been checked at its declaration */
+		if ((id = identifier.search(n->function_call.name)) == NULL)
+			raise(NameError, "identifier %s is not defined", n->function_call.name);
 
-			/* create the identifier for the formal function arguments */
-			for (size_t i = 0; i != id->node->function_declaration.arguments->size; i++)
-				identifier.add(VARIABLE, id->node->function_declaration.arguments->element[i]);
+		if (id->type != FUNCTION)
+			raise(TypeError, "identifier %s is not a function", n->function_call.name);
 
-			check(id->node->function_declaration.block);
+		if (id->node->function_declaration.arguments->size != n->function_call.arguments->size)
+			raise(SyntaxError, "%d argument(s) expected, %d found", \
+							   id->node->function_declaration.arguments->size, n->function_call.arguments->size);
 
-			scope.remove_level();
-		}
+		n->function_call.declaration = id->node;
 	} else {  /* builtin == true */
-		if (n->function_call.arguments->size != builtin_argc(n->function_call.name))
+		if (n->function_call.arguments->size != builtin_argc(n->function_call.name)) {
+			if (builtin_optional(n->function_call.name))
+				raise(SyntaxError, "builtin function %s expects %d or %d argument(s) but %d were given", \
+				      n->function_call.name, builtin_argc(n->function_call.name) - 1, builtin_argc(n->function_call.name), \
+				      n->function_call.arguments->size);
+			else
 				raise(SyntaxError, "builtin function %s expects %d argument(s) but %d were given", \
-		              n->function_call.name, builtin_argc(n->function_call.name), n->function_call.arguments->size);
+				      n->function_call.name, builtin_argc(n->function_call.name), n->function_call.arguments->size);
+		}
+
+		n->function_call.address = builtin_address(n->function_call.name);
 	}
 }
 
@@ -649,40 +1188,38 @@ void check_function_call(Node *n)
 void visit_function_call(Node *n, Stack *s)
 {
 	Node *fdecl;
-	Identifier *id;
-	Array *args = array.alloc();
+	size_t argc = n->function_call.arguments->size;
 
-	/* place the actual arguments objects in an array */
-	for (size_t i = 0; i != n->function_call.arguments->size; i++) {
+	/* the actual arguments are placed on the stack */
+	for (size_t i = 0; i != argc; i++)
 		visit(n->function_call.arguments->element[i], s);
-		array.append_child(args, stack.pop(s));
-	}
 
-	if (n->function_call.builtin == true)
-		visit_builtin(n->function_call.name, args ,s);
-	else {  /* builtin == false */
-		id = identifier.search(n->function_call.name);
-		fdecl = id->node;
+	if (n->function_call.builtin == true) {
+		Object **args = (Object **)&s->array[s->top + 1 - argc];
+
+		s->top -= argc;  /* the builtin releases the arguments and then pushes its result */
+		n->function_call.address(args, s);
+	} else {  /* builtin == false */
+		fdecl = n->function_call.declaration;
 
-		scope.append_level(id->node->function_declaration.nested);
+		display.enter(fdecl->function_declaration.depth, fdecl->function_declaration.slots);
 
-		for (size_t i = 0; i != args->size; i++) {
-			id = identifier.add(VARIABLE, fdecl->function_declaration.arguments->element[i]);
-			identifier.bind(id, obj_copy(args->element[i]));  /* create local copy */
-			obj_decref(args->element[i]);  /* release original argument */
+		/* the arguments occupy the first slots of the frame */
+		for (size_t i = argc; i-- > 0;) {
+			Object *arg = stack_pop(s);
+			display.bind(fdecl->function_declaration.depth, i, obj_copy(arg));  /* create local copy */
+			obj_decref(arg);  /* release original argument */
 		}
 
 		visit(fdecl->function_declaration.block, s);
 
-		scope.remove_level();
+		display.leave(fdecl->function_declaration.depth);
 
 		if (do_return == 0)
-			stack.push(s, obj_create(INT_T, 0));  /* result if the function did not end with a RETURN statement */
+			stack_push(s, obj_int(0));  /* result if the function did not end with a RETURN statement */
 
 		do_return = 0;
 	}
-
-	array.free(args);
 }
 
 
@@ -704,7 +1241,7 @@ void visit_expression_stmnt(Node *n, Stack *s)
 
 	visit(n->expression_stmnt.expression, s);
 
-	obj = stack.pop(s);
+	obj = stack_pop(s);
 	obj_decref(obj);  /* expression statements do not have a result */
 }
 
@@ -730,6 +1267,7 @@ void print_function_declaration(Node *n, int level)
 void check_function_declaration(Node *n)
 {
 	Identifier *id;
+	int depth = loop_depth;
 
 	if (is_builtin(n->function_declaration.name) == true)
 		raise(NameError, "builtin function %s cannot be redefined", n->function_declaration.name);
@@ -744,20 +1282,24 @@ void check_function_declaration(Node *n)
 	for (size_t i = 0; i != n->function_declaration.arguments->size; i++)
 		identifier.add(VARIABLE, (char *)n->function_declaration.arguments->element[i]);
 
+	loop_depth = 0;
 	check(n->function_declaration.block);
+	loop_depth = depth;
+
+	n->function_declaration.depth = scope.local_depth();
+	n->function_declaration.slots = scope.local_slots();
 
 	scope.remove_level();
 }
 
 
+/* Function calls are resolved to their declaration by check(), so
+ * there is nothing left to do here.
+ */
 void visit_function_declaration(Node *n, Stack *s)
 {
+	UNUSED(n);
 	UNUSED(s);
-
-	Identifier *id;
-
-	id = identifier.add(FUNCTION, n->function_declaration.name);
-	identifier.bind(id, n);
 }
 
 
@@ -794,12 +1336,16 @@ void print_defvar(Node *n, int level)
 
 void check_defvar(Node *n)
 {
+	Identifier *id;
+
 	if (is_builtin(n->defvar.name) == true)
 		raise(NameError, "%s is a builtin function", n->defvar.name);
 
-	if (identifier.add(VARIABLE ,n->defvar.name) == NULL)
+	if ((id = identifier.add(VARIABLE ,n->defvar.name)) == NULL)
 		raise(NameError, "identifier %s already declared", n->defvar.name);
 
+	n->defvar.location = (Location) { id->depth, id->slot };
+
 	if (n->defvar.initialvalue)
 		check(n->defvar.initialvalue);
 }
@@ -807,11 +1353,8 @@ void check_defvar(Node *n)
 
 void visit_defvar(Node *n, Stack *s)
 {
-	Identifier *id;
 	Object *obj;
 
-	id = identifier.add(VARIABLE, n->defvar.name);
-
 	switch (n->defvar.type) {
 		case VT_CHAR:
 			obj = obj_alloc(CHAR_T);
@@ -828,17 +1371,28 @@ void visit_defvar(Node *n, Stack *s)
 		case VT_LIST:
 			obj = obj_alloc(LIST_T);
 			break;
+		case VT_DICT:
+			obj = obj_alloc(DICT_T);
+			break;
+		case VT_SET:
+			obj = obj_alloc(SET_T);
+			break;
+		case VT_ARRAY:
+			obj = obj_alloc(NUMARRAY_T);
+			break;
 		default:
 			obj = obj_alloc(NONE_T);
 	}
 
-	identifier.bind(id, obj);
+	display.bind(n->defvar.location.depth, n->defvar.location.slot, obj);
 
 	if (n->defvar.initialvalue) {
+		Object *value;
+
 		visit(n->defvar.initialvalue, s);
-		obj = stack.pop(s);
-		obj_assign(id->object, obj);
-		obj_decref(obj);
+		value = stack_pop(s);
+		obj_assign(obj, value);
+		obj_decref(value);
 	}
 }
 
@@ -868,7 +1422,7 @@ void visit_if_stmnt(Node *n, Stack *s)
 	Object *obj;
 
 	visit(n->if_stmnt.condition, s);
-	obj = stack.pop(s);
+	obj = stack_pop(s);
 
 	if (obj_as_bool(obj) == true)
 		visit(n->if_stmnt.consequent, s);
@@ -889,7 +1443,10 @@ void print_while_stmnt(Node *n, int level)
 void check_while_stmnt(Node *n)
 {
 	check(n->loop_stmnt.condition);
+
+	loop_depth++;
 	check(n->loop_stmnt.block);
+	loop_depth--;
 }
 
 
@@ -902,7 +1459,7 @@ void visit_while_stmnt(Node *n, Stack *s)
 
 	while (1) {
 		visit(n->loop_stmnt.condition, s);
-		obj = stack.pop(s);
+		obj = stack_pop(s);
 		condition = obj_as_bool(obj);
 		obj_decref(obj);
 
@@ -912,6 +1469,9 @@ void visit_while_stmnt(Node *n, Stack *s)
 		visit(n->loop_stmnt.block, s);
 
 		do_continue = 0;
+
+		if (do_break || do_return)
+			break;
 	}
 
 	do_break = 0;
@@ -927,7 +1487,10 @@ void print_do_stmnt(Node *n, int level)
 
 void check_do_stmnt(Node *n)
 {
+	loop_depth++;
 	check(n->loop_stmnt.block);
+	loop_depth--;
+
 	check(n->loop_stmnt.condition);
 }
 
@@ -943,12 +1506,15 @@ void visit_do_stmnt(Node *n, Stack *s)
 		visit(n->loop_stmnt.block, s);
 		do_continue = 0;
 
+		if (do_break || do_return)
+			break;
+
 		visit(n->loop_stmnt.condition, s);
-		obj = stack.pop(s);
+		obj = stack_pop(s);
 		condition = obj_as_bool(obj);
 		obj_decref(obj);
 
-		if (condition == false || do_break || do_return)
+		if (condition == false)
 			break;
 	}
 
@@ -967,41 +1533,77 @@ void print_for_stmnt(Node *n, int level)
 
 void check_for_stmnt(Node *n)
 {
-	if (identifier.search(n->for_stmnt.name) == NULL)
-		identifier.add(VARIABLE, n->for_stmnt.name);
+	Identifier *id;
+
+	if ((id = identifier.search(n->for_stmnt.name)) == NULL)
+		id = identifier.add(VARIABLE, n->for_stmnt.name);
+
+	if (id->type != VARIABLE)
+		raise(TypeError, "identifier %s is not a variable", n->for_stmnt.name);
+
+	n->for_stmnt.location = (Location) { id->depth, id->slot };
 
 	check(n->for_stmnt.expression);
+
+	n->for_stmnt.range = n->for_stmnt.expression->type == FUNCTION_CALL && \
+						 n->for_stmnt.expression->function_call.builtin == true && \
+						 strcmp(n->for_stmnt.expression->function_call.name, "range") == 0;
+
+	loop_depth++;
 	check(n->for_stmnt.block);
+	loop_depth--;
 }
 
 
+/* A loop over a direct call of range() counts natively, without a cursor.
+ * A loop over a string stores the characters in the loop variable, instead
+ * of creating an object per character.
+ */
 void visit_for_stmnt(Node *n, Stack *s)
 {
-	int_t len;
-	Object *seq;
-	Identifier *id;
+	Object *seq, *cursor, *item;
+	Location *target = &n->for_stmnt.location;
+	bool string;
+	int c;
 
-	if ((id = identifier.search(n->for_stmnt.name)) == NULL)
-		id = identifier.add(VARIABLE, n->for_stmnt.name);
-
-	identifier.bind(id, obj_alloc(NONE_T));  /* result for empty lists or strings */
+	display.bind(target->depth, target->slot, obj_alloc(NONE_T));  /* result for empty lists or strings */
 
 	visit(n->for_stmnt.expression, s);
 
-	seq = stack.pop(s);
-	len = obj_length(seq);
+	seq = stack_pop(s);
 
 	do_break = do_continue = 0;
 
-	for (int_t i = 0; i < len && !do_break && !do_return; i++) {
-		identifier.bind(id, obj_item(seq, i));  /* bind() implicitly unbinds the previous object */
-		visit(n->for_stmnt.block, s);
-		do_continue = 0;
+	if (n->for_stmnt.range == true) {
+		RangeObject *range = (RangeObject *)seq;
+
+		for (int_t i = 0, count = range_length(range); i < count && !do_break && !do_return; i++) {
+			frame_bind_int(target->depth, target->slot, range->start + i * range->step);
+			visit(n->for_stmnt.block, s);
+			do_continue = 0;
+		}
+		obj_decref(seq);
+	} else {
+		string = isString(seq);
+		cursor = obj_iterate(seq);
+		obj_decref(seq);  /* the cursor holds a reference to the sequence */
+
+		if (string == true)
+			while (!do_break && !do_return && (c = strtype.nextchar((CursorObject *)cursor)) >= 0) {
+				frame_bind_char(target->depth, target->slot, (char_t)c);
+				visit(n->for_stmnt.block, s);
+				do_continue = 0;
+			}
+		else
+			while (!do_break && !do_return && (item = obj_next(cursor)) != NULL) {
+				display.bind(target->depth, target->slot, item);  /* bind() implicitly releases the previous object */
+				visit(n->for_stmnt.block, s);
+				do_continue = 0;
+			}
+		obj_decref(cursor);
 	}
 
 	do_break = 0;
-
-	obj_decref(seq);
 }
 
 
@@ -1035,7 +1637,7 @@ void visit_print_stmnt(Node *n, Stack *s)
 
 		visit(n->print_stmnt.expressions->element[i], s);
 
-		obj = stack.pop(s);
+		obj = stack_pop(s);
 
 		#ifdef VT100
 		debug_printf(~NODEBUG, "%c[032m", 27);  /* VT100 green foreground */
@@ -1072,9 +1674,15 @@ void check_return_stmnt(Node *n)
 void visit_return_stmnt(Node *n, Stack *s)
 {
 	if (n->return_stmnt.value == NULL)
-		stack.push(s, obj_create(INT_T, 0));
-	else
+		stack_push(s, obj_int(0));
+	else {
 		visit(n->return_stmnt.value, s);
+		if (is_constant(n->return_stmnt.value)) {  /* the caller may use the result as assignment target */
+			Object *obj = stack_pop(s);
+			stack_push(s, obj_copy(obj));
+			obj_decref(obj);
+		}
+	}
 
 	do_return = 1;
 }
@@ -1115,11 +1723,18 @@ void check_input_stmnt(Node *n)
 {
 	Identifier *id;
 
+	free(n->input_stmnt.locations);
+
+	if ((n->input_stmnt.locations = calloc(n->input_stmnt.identifiers->size, sizeof(Location))) == NULL)
+		raise(OutOfMemoryError);
+
 	for (size_t i = 0; i != n->input_stmnt.identifiers->size; i++) {
 		if ((id = identifier.search(n->input_stmnt.identifiers->element[i])) == NULL)
 			raise(NameError, "identifier %s is not defined", n->input_stmnt.identifiers->element[i]);
 		if (id->type != VARIABLE)
 			raise(TypeError, "identifier %s is not a variable", n->input_stmnt.identifiers->element[i]);
+
+		n->input_stmnt.locations[i] = (Location) { id->depth, id->slot };
 	}
 }
 
@@ -1128,16 +1743,19 @@ void visit_input_stmnt(Node *n, Stack *s)
 {
 	UNUSED(s);
 
-	Identifier *id;
+	Location *target;
 	Object *obj;
 
 	for (size_t i = 0; i != n->input_stmnt.identifiers->size; i++) {
 		if (n->input_stmnt.prompts->element[i])
 			printf("%s", (char *)n->input_stmnt.prompts->element[i]);
 
-		id = identifier.search(n->input_stmnt.identifiers->element[i]);
-		obj = obj_scan(stdin, TYPE(id->object));
-		identifier.bind(id, obj);
+		target = &n->input_stmnt.locations[i];
+
+		if ((obj = frame_object(target->depth, target->slot)) == NULL)
+			raise(NameError, "variable %s has no value", n->input_stmnt.identifiers->element[i]);
+
+		display.bind(target->depth, target->slot, obj_scan(stdin, TYPE(obj)));
 	}
 }
 
@@ -1172,6 +1790,9 @@ void print_break_stmnt(Node *n, int level)
 void check_break_stmnt(Node *n)
 {
 	UNUSED(n);
+
+	if (loop_depth == 0)
+		raise(SyntaxError, "break outside loop");
 }
 
 
@@ -1194,6 +1815,9 @@ void print_continue_stmnt(Node *n, int level)
 void check_continue_stmnt(Node *n)
 {
 	UNUSED(n);
+
+	if (loop_depth == 0)
+		raise(SyntaxError, "continue outside loop");
 }
 
 
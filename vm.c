@@ -0,0 +1,713 @@
+/* vm.c
+ *
+ * Virtual machine which executes the bytecode produced by compile.c.
+ *
+ * This is an alternative for executing the AST via visit(). Instead of
+ * recursively visiting nodes the instructions of a code object are
+ * executed one after the other in a single dispatch loop. Values are
+ * exchanged via a contiguous operand stack, which is shared by all
+ * active function calls.
+ *
+ * When compiled with GCC (or any other compiler supporting 'labels as
+ * values') the instructions are direct threaded: every instruction
+ * holds the address of its handler and each handler jumps straight to
+ * the handler of the next instruction. Other compilers fall back to a
+ * switch statement. Define NO_COMPUTED_GOTO to force the fallback.
+ */
+#include <stdlib.h>
+
+#include "function.h"
+#include "number.h"
+#include "config.h"
+#include "error.h"
+#include "frame.h"
+#include "visit.h"
+#include "list.h"
+#include "cursor.h"
+#include "range.h"
+#include "str.h"
+#include "vm.h"
+
+#if defined(__GNUC__) && !defined(NO_COMPUTED_GOTO)
+#define COMPUTED_GOTO
+#endif
+
+
+/* The operand stack. The stack frame of the code being executed starts at
+ * 'top', frames of the callers are below it. Field 'top' is only updated
+ * when a new code object is executed, within a frame the virtual machine
+ * uses a local stack pointer.
+ */
+static struct {
+	Object **base;		/* first element of the stack */
+	size_t capacity;	/* size of the stack as number of elements */
+	size_t top;			/* index of the first free element */
+} vmstack = { NULL, 0, 0 };
+
+static Stack *results = NULL;	/* builtin functions return their result via a Stack */
+
+
+/* Make sure the operand stack can hold at least n more elements.
+ */
+static void reserve(size_t n)
+{
+	size_t capacity;
+
+	if (vmstack.top + n > vmstack.capacity) {
+		capacity = vmstack.capacity ? vmstack.capacity * 2 : 256;
+		if (capacity < vmstack.top + n)
+			capacity = vmstack.top + n;
+		if ((vmstack.base = realloc(vmstack.base, capacity * sizeof(Object *))) == NULL)
+			raise(OutOfMemoryError);
+		vmstack.capacity = capacity;
+	}
+}
+
+
+/* Apply a binary operator on two operands. The caller releases the left
+ * operand afterwards, so arithmetic may store its result in it.
+ */
+static Object *binary(binaryoperator_t operator, Object *left, Object *right)
+{
+	switch (operator) {
+		case ADD:
+			return obj_add_tmp(left, right);
+		case SUB:
+			return obj_sub_tmp(left, right);
+		case MUL:
+			return obj_mult_tmp(left, right);
+		case DIV:
+			return obj_divs_tmp(left, right);
+		case MOD:
+			return obj_mod_tmp(left, right);
+		case LSS:
+			return obj_lss(left, right);
+		case LEQ:
+			return obj_leq(left, right);
+		case GTR:
+			return obj_gtr(left, right);
+		case GEQ:
+			return obj_geq(left, right);
+		case EQ:
+			return obj_eql(left, right);
+		case NEQ:
+			return obj_neq(left, right);
+		case OP_IN:
+			return obj_in(left, right);
+		case LOGICAL_AND:
+			return obj_and(left, right);
+		case LOGICAL_OR:
+			return obj_or(left, right);
+	}
+	return obj_alloc(NONE_T);
+}
+
+
+/* Calculate the new value of an assignment target, in place.
+ */
+static void assignment(assignmentoperator_t operator, Object *target, Object *value)
+{
+	switch (operator) {
+		case ASSIGN:
+			obj_assign(target, value);
+			break;
+		case ADDASSIGN:
+			obj_iadd(target, value);
+			break;
+		case SUBASSIGN:
+			obj_isub(target, value);
+			break;
+		case MULASSIGN:
+			obj_imult(target, value);
+			break;
+		case DIVASSIGN:
+			obj_idivs(target, value);
+			break;
+		case MODASSIGN:
+			obj_imod(target, value);
+			break;
+	}
+}
+
+
+/* Function which calculates the new value of an element for a compound
+ * assignment, see arithmetic() in visit.c.
+ */
+static kernel_t arithmetic(assignmentoperator_t operator)
+{
+	switch (operator) {
+		case ADDASSIGN:
+			return obj_add_tmp;
+		case SUBASSIGN:
+			return obj_sub_tmp;
+		case MULASSIGN:
+			return obj_mult_tmp;
+		case DIVASSIGN:
+			return obj_divs_tmp;
+		default:  /* MODASSIGN */
+			return obj_mod_tmp;
+	}
+}
+
+
+/* Compare two integers.
+ */
+static inline bool compare(binaryoperator_t operator, int_t left, int_t right)
+{
+	switch (operator) {
+		case LSS:
+			return left < right;
+		case LEQ:
+			return left <= right;
+		case GTR:
+			return left > right;
+		case GEQ:
+			return left >= right;
+		case EQ:
+			return left == right;
+		case NEQ:
+			return left != right;
+		default:
+			return false;
+	}
+}
+
+
+/* API: Execute a code object.
+ *
+ * code		code object to execute
+ * return	result of a RETURN instruction, NULL if the code ended with HALT
+ */
+Object *execute(Code *code)
+{
+	Node *tmp = current_node;
+	size_t bottom = vmstack.top;
+	Instruction *ip = code->instr;
+	Object **sp, *obj, *result = NULL;
+
+	#ifdef COMPUTED_GOTO
+	static void *labels[] = {
+		[OP_HALT] = &&op_halt, [OP_POP] = &&op_pop, [OP_CONST] = &&op_const,
+		[OP_COPY] = &&op_copy, [OP_LOAD] = &&op_load, [OP_LOAD_TARGET] = &&op_load_target,
+		[OP_DEFVAR] = &&op_defvar, [OP_INIT] = &&op_init, [OP_UNARY] = &&op_unary,
+		[OP_BINARY] = &&op_binary, [OP_ASSIGN] = &&op_assign, [OP_INDEX] = &&op_index,
+		[OP_STORE_INDEX] = &&op_store_index, [OP_UPDATE_INDEX] = &&op_update_index,
+		[OP_SLICE] = &&op_slice, [OP_LIST] = &&op_list, [OP_CALL] = &&op_call,
+		[OP_BUILTIN] = &&op_builtin, [OP_METHOD] = &&op_method, [OP_JUMP] = &&op_jump,
+		[OP_JUMP_FALSE] = &&op_jump_false, [OP_JUMP_LOGICAL] = &&op_jump_logical,
+		[OP_COMPARE_JUMP] = &&op_compare_jump,
+		[OP_FOR_PREP] = &&op_for_prep, [OP_FOR_INIT] = &&op_for_init,
+		[OP_FOR_NEXT] = &&op_for_next, [OP_FOR_RANGE] = &&op_for_range, [OP_FOR_END] = &&op_for_end, [OP_PRINT] = &&op_print,
+		[OP_PRINT_SPACE] = &&op_print_space, [OP_PRINT_NEWLINE] = &&op_print_newline,
+		[OP_INPUT] = &&op_input, [OP_RETURN] = &&op_return
+	};
+
+	if (code->threaded == false) {
+		for (size_t i = 0; i != code->size; i++)
+			code->instr[i].label = labels[code->instr[i].opcode];
+		code->threaded = true;
+	}
+
+	#define TARGET(op, label)	label:
+	#define DISPATCH()			do { current_node = ip->node; goto *ip->label; } while (0)
+	#else  /* not COMPUTED_GOTO */
+	#define TARGET(op, label)	case op:
+	#define DISPATCH()			goto dispatch
+	#endif  /* COMPUTED_GOTO */
+
+	#define NEXT()				do { ip++; DISPATCH(); } while (0)
+	#define JUMP(index)			do { ip = code->instr + (index); DISPATCH(); } while (0)
+
+	reserve(code->maxdepth);
+	sp = vmstack.base + bottom;
+
+	#ifdef COMPUTED_GOTO
+	DISPATCH();
+	#else
+	dispatch:
+	current_node = ip->node;
+
+	switch (ip->opcode) {
+	#endif  /* COMPUTED_GOTO */
+
+	TARGET(OP_HALT, op_halt) {
+		goto end;
+	}
+
+	TARGET(OP_POP, op_pop) {
+		obj_decref(*--sp);
+		NEXT();
+	}
+
+	TARGET(OP_CONST, op_const) {
+		obj = ip->operand;
+		obj_incref(obj);
+		*sp++ = obj;
+		NEXT();
+	}
+
+	TARGET(OP_COPY, op_copy) {
+		obj = sp[-1];
+		sp[-1] = obj_copy(obj);
+		obj_decref(obj);
+		NEXT();
+	}
+
+	TARGET(OP_LOAD, op_load) {
+		if ((obj = frame_object(ip->depth, ip->arg)) == NULL)
+			raise(NameError, "variable %s has no value", (char *)ip->operand);
+
+		if (isListNode(obj))  /* variable of a for-in loop, its value is the list element */
+			obj = obj_from_listnode(obj);
+		else
+			obj_incref(obj);
+
+		*sp++ = obj;
+		NEXT();
+	}
+
+	TARGET(OP_LOAD_TARGET, op_load_target) {
+		/* the object bound to the variable, for a for-in loop variable the listnode */
+		if ((obj = frame_object(ip->depth, ip->arg)) == NULL)
+			raise(NameError, "variable %s has no value", (char *)ip->operand);
+
+		obj_incref(obj);
+		*sp++ = obj;
+		NEXT();
+	}
+
+	TARGET(OP_DEFVAR, op_defvar) {
+		Node *n = ip->operand;
+
+		switch (n->defvar.type) {
+			case VT_CHAR:
+				obj = obj_alloc(CHAR_T);
+				break;
+			case VT_INT:
+				obj = obj_alloc(INT_T);
+				break;
+			case VT_FLOAT:
+				obj = obj_alloc(FLOAT_T);
+				break;
+			case VT_STR:
+				obj = obj_alloc(STR_T);
+				break;
+			case VT_LIST:
+				obj = obj_alloc(LIST_T);
+				break;
+			case VT_DICT:
+				obj = obj_alloc(DICT_T);
+				break;
+			case VT_SET:
+				obj = obj_alloc(SET_T);
+				break;
+			case VT_ARRAY:
+				obj = obj_alloc(NUMARRAY_T);
+				break;
+			default:
+				obj = obj_alloc(NONE_T);
+		}
+
+		display.bind(n->defvar.location.depth, n->defvar.location.slot, obj);
+
+		if (ip->arg) {  /* variable is initialized, push the target for OP_INIT */
+			obj_incref(obj);
+			*sp++ = obj;
+		}
+		NEXT();
+	}
+
+	TARGET(OP_INIT, op_init) {
+		Object *value = *--sp;
+		Object *target = *--sp;
+
+		obj_assign(target, value);
+		obj_decref(value);
+		obj_decref(target);
+		NEXT();
+	}
+
+	TARGET(OP_UNARY, op_unary) {
+		obj = sp[-1];
+
+		if (ip->arg == UNOT)
+			sp[-1] = obj_negate(obj);
+		else  /* UMINUS */
+			sp[-1] = obj_invert(obj);
+
+		obj_decref(obj);
+		NEXT();
+	}
+
+	TARGET(OP_BINARY, op_binary) {
+		Object *right = *--sp;
+		Object *left = sp[-1];
+
+		if (TYPE(left) == INT_T && TYPE(right) == INT_T) {
+			int_t l = int_value(left);
+			int_t r = int_value(right);
+
+			switch (ip->arg) {
+				case ADD:
+					obj = obj_int(l + r);
+					break;
+				case SUB:
+					obj = obj_int(l - r);
+					break;
+				case MUL:
+					obj = obj_int(l * r);
+					break;
+				case DIV:
+					obj = r ? obj_int(l / r) : binary(ip->arg, left, right);
+					break;
+				case MOD:
+					obj = r ? obj_int(l % r) : binary(ip->arg, left, right);
+					break;
+				case LSS:
+				case LEQ:
+				case GTR:
+				case GEQ:
+				case EQ:
+				case NEQ:
+					obj = obj_bool(compare(ip->arg, l, r));
+					break;
+				default:
+					obj = binary(ip->arg, left, right);
+			}
+		} else
+			obj = binary(ip->arg, left, right);
+
+		sp[-1] = obj;
+		obj_decref(left);
+		obj_decref(right);
+		NEXT();
+	}
+
+	TARGET(OP_ASSIGN, op_assign) {
+		Object *value = *--sp;
+		Object *target = sp[-1];  /* the target remains on the stack as result */
+
+		if (isImmediate(target))  /* an immediate cannot be modified, so assign to a copy */
+			sp[-1] = target = obj_copy(target);
+
+		if (TYPE(target) == INT_T && TYPE(value) == INT_T && ip->arg <= MULASSIGN) {
+			/* integers are modified in place, no intermediate objects needed */
+			switch (ip->arg) {
+				case ASSIGN:
+					((IntObject *)target)->ival = int_value(value);
+					break;
+				case ADDASSIGN:
+					((IntObject *)target)->ival += int_value(value);
+					break;
+				case SUBASSIGN:
+					((IntObject *)target)->ival -= int_value(value);
+					break;
+				case MULASSIGN:
+					((IntObject *)target)->ival *= int_value(value);
+					break;
+			}
+		} else {
+			assignment(ip->arg, target, value);
+
+			if (isListNode(target)) {  /* the result is the element which was assigned */
+				sp[-1] = obj_from_listnode(target);
+				obj_decref(target);
+			}
+		}
+
+		obj_decref(value);
+		NEXT();
+	}
+
+	TARGET(OP_INDEX, op_index) {
+		Object *index = *--sp;
+		Object *sequence = sp[-1];
+
+		sp[-1] = obj_subscript(sequence, index);
+
+		obj_decref(index);
+		obj_decref(sequence);
+		NEXT();
+	}
+
+	TARGET(OP_STORE_INDEX, op_store_index) {
+		Object *value = *--sp;
+		Object *index = *--sp;
+		Object *sequence = sp[-1];
+
+		sp[-1] = obj_store_item(sequence, index, value);
+
+		obj_decref(value);
+		obj_decref(index);
+		obj_decref(sequence);
+		NEXT();
+	}
+
+	TARGET(OP_UPDATE_INDEX, op_update_index) {
+		Object *value = *--sp;
+		Object *index = *--sp;
+		Object *sequence = sp[-1];
+
+		sp[-1] = obj_update_item(sequence, index, arithmetic(ip->arg), value);
+
+		obj_decref(value);
+		obj_decref(index);
+		obj_decref(sequence);
+		NEXT();
+	}
+
+	TARGET(OP_SLICE, op_slice) {
+		Object *end = *--sp;
+		Object *start = *--sp;
+		Object *sequence = sp[-1];
+
+		sp[-1] = obj_slice(sequence, obj_as_int(start), obj_as_int(end));
+
+		obj_decref(end);
+		obj_decref(start);
+		obj_decref(sequence);
+		NEXT();
+	}
+
+	TARGET(OP_LIST, op_list) {
+		Object **args = sp - ip->arg;
+
+		obj = obj_alloc(LIST_T);
+
+		for (long i = 0; i != ip->arg; i++) {
+			listtype.append((ListObject *)obj, obj_copy(args[i]));
+			obj_decref(args[i]);
+		}
+
+		sp = args;
+		*sp++ = obj;
+		NEXT();
+	}
+
+	TARGET(OP_CALL, op_call) {
+		Object **args = sp - ip->arg;
+		Node *fdecl = ip->operand;
+		int depth = fdecl->function_declaration.depth;
+
+		display.enter(depth, fdecl->function_declaration.slots);
+
+		/* the arguments occupy the first slots of the frame */
+		for (long i = 0; i != ip->arg; i++) {
+			display.bind(depth, i, obj_copy(args[i]));  /* create local copy */
+			obj_decref(args[i]);  /* release original argument */
+		}
+
+		vmstack.top = args - vmstack.base;  /* the callee's frame starts here */
+
+		obj = execute(fdecl->function_declaration.code);
+
+		sp = vmstack.base + vmstack.top;  /* the stack may have been moved by realloc */
+		vmstack.top = bottom;
+
+		display.leave(depth);
+
+		*sp++ = obj;
+		NEXT();
+	}
+
+	TARGET(OP_BUILTIN, op_builtin) {
+		Node *call = ip->operand;
+
+		if (results == NULL)
+			results = stack.alloc(1);
+
+		sp -= ip->arg;
+		call->function_call.address(sp, results);  /* builtins release the arguments */
+
+		*sp++ = stack_pop(results);
+		NEXT();
+	}
+
+	TARGET(OP_METHOD, op_method) {
+		Array *args = array.alloc();
+
+		sp -= ip->arg;
+		for (long i = 0; i != ip->arg; i++)
+			array.append_child(args, sp[i]);
+
+		obj = sp[-1];
+		sp[-1] = obj_method(obj, ip->operand, args);
+
+		for (long i = 0; i != ip->arg; i++)
+			obj_decref(args->element[i]);
+
+		obj_decref(obj);
+
+		array.free(args);
+		NEXT();
+	}
+
+	TARGET(OP_JUMP, op_jump) {
+		JUMP(ip->target);
+	}
+
+	TARGET(OP_JUMP_FALSE, op_jump_false) {
+		bool condition;
+
+		obj = *--sp;
+		condition = obj_as_bool(obj);
+		obj_decref(obj);
+
+		if (condition == false)
+			JUMP(ip->target);
+		NEXT();
+	}
+
+	TARGET(OP_JUMP_LOGICAL, op_jump_logical) {
+		/* If the left operand decides the result of 'and' or 'or' replace it
+		 * by the result and skip the right operand. Otherwise leave it on
+		 * the stack for OP_BINARY, which also reports invalid operand types.
+		 */
+		obj = sp[-1];
+
+		if (isNumber(obj) && obj_as_bool(obj) == (ip->arg == LOGICAL_OR)) {
+			obj_decref(sp[-1]);
+			sp[-1] = obj_bool(ip->arg == LOGICAL_OR);
+			JUMP(ip->target);
+		}
+		NEXT();
+	}
+
+	TARGET(OP_COMPARE_JUMP, op_compare_jump) {
+		Object *right = *--sp;
+		Object *left = *--sp;
+		bool condition;
+
+		if (TYPE(left) == INT_T && TYPE(right) == INT_T)
+			condition = compare(ip->arg, int_value(left), int_value(right));
+		else {
+			obj = binary(ip->arg, left, right);
+			condition = obj_as_bool(obj);
+			obj_decref(obj);
+		}
+
+		obj_decref(left);
+		obj_decref(right);
+
+		if (condition == false)
+			JUMP(ip->target);
+		NEXT();
+	}
+
+	TARGET(OP_FOR_PREP, op_for_prep) {
+		display.bind(ip->depth, ip->arg, obj_alloc(NONE_T));  /* result for empty lists or strings */
+		NEXT();
+	}
+
+	TARGET(OP_FOR_INIT, op_for_init) {
+		obj = sp[-1];
+		sp[-1] = obj_iterate(obj);  /* the cursor replaces the sequence */
+		obj_decref(obj);
+		NEXT();
+	}
+
+	TARGET(OP_FOR_NEXT, op_for_next) {  /* sp[-1] is a cursor */
+		CursorObject *cursor = (CursorObject *)sp[-1];
+		int c;
+
+		if (isString(cursor->sequence)) {  /* store the character in the variable, no object per character */
+			if ((c = strtype.nextchar(cursor)) < 0)
+				JUMP(ip->target);
+
+			frame_bind_char(ip->depth, ip->arg, (char_t)c);
+			NEXT();
+		}
+
+		if ((obj = obj_next(sp[-1])) == NULL)
+			JUMP(ip->target);
+
+		display.bind(ip->depth, ip->arg, obj);  /* bind() implicitly releases the previous object */
+		NEXT();
+	}
+
+	TARGET(OP_FOR_RANGE, op_for_range) {  /* sp[-1] is a cursor over a range */
+		CursorObject *cursor = (CursorObject *)sp[-1];
+		RangeObject *range = (RangeObject *)cursor->sequence;
+
+		if (cursor->index >= cursor->end)
+			JUMP(ip->target);
+
+		frame_bind_int(ip->depth, ip->arg, range->start + cursor->index++ * range->step);
+		NEXT();
+	}
+
+	TARGET(OP_FOR_END, op_for_end) {
+		obj_decref(*--sp);
+		NEXT();
+	}
+
+	TARGET(OP_PRINT, op_print) {
+		obj = *--sp;
+
+		#ifdef VT100
+		debug_printf(~NODEBUG, "%c[032m", 27);  /* VT100 green foreground */
+		#endif  /* VT100 */
+
+		obj_print(stdout, obj);
+
+		#ifdef VT100
+		debug_printf(~NODEBUG, "%c[0m", 27);  /* VT100 standard foreground */
+		#endif  /* VT100 */
+
+		obj_decref(obj);
+		NEXT();
+	}
+
+	TARGET(OP_PRINT_SPACE, op_print_space) {
+		printf(" ");
+		NEXT();
+	}
+
+	TARGET(OP_PRINT_NEWLINE, op_print_newline) {
+		printf("\n");
+		NEXT();
+	}
+
+	TARGET(OP_INPUT, op_input) {
+		Node *n = ip->operand;
+		Location *target;
+
+		for (size_t i = 0; i != n->input_stmnt.identifiers->size; i++) {
+			if (n->input_stmnt.prompts->element[i])
+				printf("%s", (char *)n->input_stmnt.prompts->element[i]);
+
+			target = &n->input_stmnt.locations[i];
+
+			if ((obj = frame_object(target->depth, target->slot)) == NULL)
+				raise(NameError, "variable %s has no value", n->input_stmnt.identifiers->element[i]);
+
+			display.bind(target->depth, target->slot, obj_scan(stdin, TYPE(obj)));
+		}
+		NEXT();
+	}
+
+	TARGET(OP_RETURN, op_return) {
+		result = *--sp;
+
+		/* release what loops have left on the stack */
+		while (sp > vmstack.base + bottom)
+			obj_decref(*--sp);
+
+		goto end;
+	}
+
+	#ifndef COMPUTED_GOTO
+	}  /* switch */
+	#endif  /* COMPUTED_GOTO */
+
+	#undef TARGET
+	#undef DISPATCH
+	#undef NEXT
+	#undef JUMP
+
+end:
+	vmstack.top = bottom;
+	current_node = tmp;
+
+	return result;
+}
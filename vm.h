@@ -0,0 +1,13 @@
+/* vm.h
+ *
+ * Virtual machine which executes bytecode, see vm.c.
+ */
+#ifndef _VM_
+#define _VM_
+
+#include "compile.h"
+#include "object.h"
+
+extern Object *execute(Code *code);
+
+#endif